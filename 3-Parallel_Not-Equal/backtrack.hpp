@@ -0,0 +1,764 @@
+#ifndef PARALLEL_NOT_EQUAL_BACKTRACK_HPP
+#define PARALLEL_NOT_EQUAL_BACKTRACK_HPP
+
+// Generic tree-search (backtracking) engines: sequential DFS, work-stealing DFS (with
+// optional periodic checkpoints and progress reports), two-phase frontier search,
+// memory-bounded hybrid BFS/DFS search and parallel best-first search.
+//
+// A problem is a class with a nested `Node` type, which must be trivially copyable (the
+// nodes are stored by bytes in slabs and lock-free deques), and the callbacks:
+//
+//   bool is_leaf(const Node&) const     the node is a solution: it is counted, not branched
+//   template <typename Push>
+//   void branch(const Node&, Push&& push) const
+//                                       call `push(child)` for each child of the node, in
+//                                       the order they are to be explored
+//   size_t depth(const Node&) const     depth of the node in the tree (frontier search)
+//
+// and optionally, for the work-stealing search:
+//
+//   size_t record_size() const          size in bytes of an encoded node, and
+//   void encode(const Node&, std::vector<uint8_t>&) const
+//                                       append the encoding of a node (checkpoints)
+//   double weight(const Node&) const    estimated fraction of the whole tree below a node
+//                                       (ETA of the progress reports)
+//
+// and, for all the engines:
+//
+//   void write_solution(const Node&, SolutionStream::Writer&) const
+//                                       write the records of a leaf (streamed solutions)
+//
+// and, for the best-first search:
+//
+//   double priority(const Node&) const  the open node of highest priority is explored first
+//
+// The engines count the nodes generated (`exploredTree`) and the leaves reached
+// (`exploredSol`). The callbacks are inlined in the search loops, so a problem pays no
+// abstraction cost over a hand-written search.
+
+#include <iostream>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <chrono>
+#include <stack>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <memory>
+#include <sys/resource.h>
+
+#include "slab.hpp"
+#include "pool.hpp"
+#include "checkpoint.hpp"
+#include "solutions.hpp"
+
+// detection of the optional callbacks of a problem
+template <typename Problem, typename = void>
+struct has_encode : std::false_type {};
+template <typename Problem>
+struct has_encode<Problem, std::void_t<decltype(std::declval<const Problem&>().encode(
+    std::declval<const typename Problem::Node&>(), std::declval<std::vector<uint8_t>&>()))>> : std::true_type {};
+
+template <typename Problem, typename = void>
+struct has_weight : std::false_type {};
+template <typename Problem>
+struct has_weight<Problem, std::void_t<decltype(std::declval<const Problem&>().weight(
+    std::declval<const typename Problem::Node&>()))>> : std::true_type {};
+
+template <typename Problem, typename = void>
+struct has_priority : std::false_type {};
+template <typename Problem>
+struct has_priority<Problem, std::void_t<decltype(std::declval<const Problem&>().priority(
+    std::declval<const typename Problem::Node&>()))>> : std::true_type {};
+
+template <typename Problem, typename = void>
+struct has_write_solution : std::false_type {};
+template <typename Problem>
+struct has_write_solution<Problem, std::void_t<decltype(std::declval<const Problem&>().write_solution(
+    std::declval<const typename Problem::Node&>(), std::declval<SolutionStream::Writer&>()))>> : std::true_type {};
+
+// Evaluate a given node: count it and write it to `out` if it is a solution, and push its
+// child nodes into `pool` otherwise.
+// It is not inlined so that the parent is read from memory for each child, instead of being
+// split into registers and rebuilt for each copy, which is 10-20% faster on N-Queens.
+template <typename Problem, typename Pool>
+__attribute__((noinline)) void evaluate_and_branch(const Problem& problem, const typename Problem::Node& parent, Pool& pool,
+                                                          size_t& tree_loc, size_t& num_sol,
+                                                          SolutionStream::Writer* out = nullptr)
+{
+  // if the given node is a leaf, then update counter and do nothing
+  if (problem.is_leaf(parent)) {
+    num_sol++;
+    if constexpr (has_write_solution<Problem>::value) {
+      if (out != nullptr) problem.write_solution(parent, *out);
+    }
+    return;
+  }
+  // if the given node is not a leaf, then branch it and count its children
+  problem.branch(parent, [&](const typename Problem::Node& child) {
+    pool.push(child);
+    tree_loc++;
+  });
+}
+
+// pool of nodes explored in DFS order, stored in a slab
+template <typename Node>
+using NodeStack = std::stack<Node, SlabDeque<Node>>;
+
+// sequential Depth-First tree-Search of the nodes in `pool`, writing the solutions to `out`
+// if given, until the pool is empty or the stream of `out` asks to stop
+template <typename Problem>
+void dfs(const Problem& problem, NodeStack<typename Problem::Node>& pool, size_t& exploredTree, size_t& exploredSol,
+         SolutionStream::Writer* out = nullptr)
+{
+  // local counters, which the compiler can keep in registers
+  size_t tree_loc = 0;
+  size_t num_sol = 0;
+
+  while (pool.size() != 0 && !(out != nullptr && out->stopped())) {
+    // get a node from the pool
+    typename Problem::Node currentNode(std::move(pool.top()));
+    pool.pop();
+
+    // check the node and branch it if it is not a solution
+    evaluate_and_branch(problem, currentNode, pool, tree_loc, num_sol, out);
+  }
+
+  exploredTree += tree_loc;
+  exploredSol += num_sol;
+}
+
+// periodic checkpoints of a work-stealing search
+struct CheckpointConfig {
+  std::string file;       // checkpoint file (empty: no checkpoint)
+  double interval = 60.0; // time between two checkpoints, in seconds
+  CheckpointHeader header{}; // problem size and flags stored with the snapshots
+};
+
+// periodic progress reports of a work-stealing search
+struct TelemetryConfig {
+  double interval = 0.0;          // time between two reports, in seconds (0: no report)
+  std::ostream* out = &std::cerr; // stream the reports are written to
+};
+
+// work-stealing Depth-First tree-Search using `num_threads` workers, each owning a pool of
+// type `Pool` (see pool.hpp). The counters are accumulated per worker and summed at the
+// end, so they match the sequential search.
+//
+// Termination: a worker whose pool is empty and that fails to steal declares itself
+// idle. Only owners push into their pool, so once all the workers are idle, no node is
+// left anywhere. An idle worker leaves the idle state *before* stealing, so a node in
+// transit is never missed.
+//
+// Checkpoints and progress reports: the calling thread periodically requests a pause.
+// Each worker checks the request between two nodes, i.e. when all its nodes are in the
+// pools, publishes its counters and waits. Once every worker is paused (or done), the
+// counters and the pools are copied, the workers resume, and only then is the snapshot
+// written to disk or summarized. The workers only keep plain local counters; nothing is
+// shared while they run.
+//
+// The progress of the search is estimated from the snapshot: the open nodes are the roots
+// of the subtrees left to explore, so the explored fraction of the tree is one minus the
+// sum of their weights, relative to the weight of the roots.
+//
+// Breadth-first fallback: with `breadth_limit` > 0, while some workers are idle, a worker
+// whose pool holds less than `breadth_limit` nodes expands its shallowest node instead of
+// its deepest one, which gives the idle workers more nodes to steal. The pools return to
+// DFS order as soon as nobody is idle, so their size stays bounded.
+//
+// Solutions: with a stream, each worker writes its solutions through its own writer, and
+// all the workers leave as soon as the stream asks to stop.
+//
+// Returns the peak footprint of the pools, in bytes.
+template <typename Pool, typename Problem>
+size_t parallel_dfs(const Problem& problem, const std::vector<typename Problem::Node>& roots, size_t num_threads,
+                    size_t& exploredTree, size_t& exploredSol,
+                    const CheckpointConfig& checkpoint = CheckpointConfig(),
+                    const TelemetryConfig& telemetry = TelemetryConfig(), size_t breadth_limit = 0,
+                    SolutionStream* solutions = nullptr)
+{
+  using Node = typename Problem::Node;
+  using Clock = std::chrono::steady_clock;
+  if constexpr (!has_encode<Problem>::value) {
+    if (!checkpoint.file.empty()) throw std::invalid_argument("this problem does not support checkpoints");
+  }
+
+  std::vector<Pool> pools(num_threads);
+  Pool::share(pools);
+  std::atomic<size_t> idle{0};
+  std::atomic<size_t> tree_total{0};
+  std::atomic<size_t> sol_total{0};
+
+  // pause protocol for the checkpoints and the progress reports
+  struct alignas(64) Published {
+    size_t tree = 0;
+    size_t sol = 0;
+    size_t steals = 0;    // successful steals
+    double idle_s = 0.0;  // time spent looking for work, in seconds
+    size_t max_depth = 0; // depth of the deepest node explored
+  };
+  std::vector<Published> published(num_threads);
+  std::atomic<bool> pause_requested{false};
+  std::atomic<size_t> paused{0};
+  std::atomic<size_t> finished{0};
+  std::mutex finished_lock;
+  std::condition_variable finished_cv;
+
+  for (size_t i = 0; i < roots.size(); i++) {
+    pools[i % num_threads].push(roots[i]);
+  }
+
+  auto worker = [&](size_t id) {
+    size_t tree_loc = 0;
+    size_t num_sol = 0;
+    size_t steals = 0;
+    double idle_s = 0.0;
+    size_t max_depth = 0;
+    Clock::time_point idle_start;
+    bool idling = false;
+    std::minstd_rand rng(id + 1);
+    Node currentNode;
+    std::unique_ptr<SolutionStream::Writer> out;
+    if (solutions != nullptr) out.reset(new SolutionStream::Writer(*solutions));
+    auto stopped = [&]() { return out != nullptr && out->stopped(); };
+
+    auto publish = [&]() {
+      Published& p = published[id];
+      p.tree = tree_loc;
+      p.sol = num_sol;
+      p.steals = steals;
+      p.idle_s = idle_s + (idling ? std::chrono::duration<double>(Clock::now() - idle_start).count() : 0.0);
+      p.max_depth = max_depth;
+    };
+
+    // wait while a snapshot is taken, if one is requested
+    auto pause_point = [&]() {
+      if (!pause_requested.load(std::memory_order_relaxed)) return;
+      publish();
+      paused.fetch_add(1);
+      while (pause_requested.load()) std::this_thread::yield();
+      paused.fetch_sub(1);
+    };
+
+    while (true) {
+      // depth-first on the local pool (breadth-first while other workers are idle)
+      while (true) {
+        pause_point();
+        if (stopped()) break;
+        bool breadth_first = breadth_limit > 0 && idle.load(std::memory_order_relaxed) > 0
+                             && pools[id].size() < breadth_limit;
+        if (!(breadth_first ? pools[id].steal(currentNode) : pools[id].pop(currentNode))) break;
+        max_depth = std::max<size_t>(max_depth, problem.depth(currentNode));
+        evaluate_and_branch(problem, currentNode, pools[id], tree_loc, num_sol, out.get());
+      }
+      if (stopped()) break;
+
+      // local pool is empty: look for a victim, starting from a random one
+      bool found = false;
+      idle_start = Clock::now();
+      idling = true;
+      idle.fetch_add(1);
+      while (!found) {
+        if (idle.load() == num_threads || stopped()) break;
+        pause_point();
+
+        size_t start = rng() % num_threads;
+        for (size_t k = 0; k < num_threads && !found; k++) {
+          size_t victim = (start + k) % num_threads;
+          if (victim == id || pools[victim].size() == 0) continue;
+
+          idle.fetch_sub(1);
+          if (pools[victim].steal(currentNode)) {
+            found = true;
+          } else {
+            idle.fetch_add(1);
+          }
+        }
+        if (!found) std::this_thread::yield();
+      }
+      idle_s += std::chrono::duration<double>(Clock::now() - idle_start).count();
+      idling = false;
+      if (!found) break;
+
+      steals++;
+      max_depth = std::max<size_t>(max_depth, problem.depth(currentNode));
+      evaluate_and_branch(problem, currentNode, pools[id], tree_loc, num_sol, out.get());
+    }
+
+    if (out != nullptr) out->flush();
+    tree_total.fetch_add(tree_loc);
+    sol_total.fetch_add(num_sol);
+    publish();
+    {
+      std::lock_guard<std::mutex> guard(finished_lock);
+      finished.fetch_add(1);
+    }
+    finished_cv.notify_all();
+  };
+
+  const Clock::time_point start = Clock::now();
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < num_threads; id++) {
+    threads.emplace_back(worker, id);
+  }
+
+  // estimated fraction of the tree below the nodes of `nodes`
+  auto total_weight = [&](const std::vector<Node>& nodes) {
+    double weight = 0.0;
+    if constexpr (has_weight<Problem>::value) {
+      for (const Node& node : nodes) weight += problem.weight(node);
+    }
+    return weight;
+  };
+
+  // progress report, from the counters of the workers and the open nodes
+  bool checkpoints = !checkpoint.file.empty(); // cleared if a checkpoint cannot be written
+  const bool reports = telemetry.interval > 0.0;
+  const double root_weight = reports ? total_weight(roots) : 0.0;
+  size_t last_tree = exploredTree;
+  double last_elapsed = 0.0;
+  auto report = [&](const std::vector<Published>& counters, const std::vector<Node>& open, double elapsed) {
+    size_t tree = exploredTree, sol = exploredSol, steals = 0, max_depth = 0;
+    for (const Published& p : counters) {
+      tree += p.tree;
+      sol += p.sol;
+      steals += p.steals;
+      max_depth = std::max(max_depth, p.max_depth);
+    }
+    double done = root_weight > 0.0 ? std::max(0.0, 1.0 - total_weight(open) / root_weight) : 0.0;
+    if (open.empty()) done = 1.0;
+    double rate = elapsed > last_elapsed ? (tree - last_tree) / (elapsed - last_elapsed) : 0.0;
+    last_tree = tree;
+    last_elapsed = elapsed;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "[PROGRESS] " << elapsed << " s: "
+         << std::scientific << std::setprecision(3) << rate << " nodes/s, " << tree << " nodes, "
+         << sol << " solutions, pool " << open.size() << ", max depth " << max_depth
+         << ", steals " << steals << ", idle (s)" << std::fixed << std::setprecision(1);
+    for (const Published& p : counters) line << " " << p.idle_s;
+    line << ", " << 100.0 * done << "% done, ETA ";
+    if (done > 0.0) line << elapsed * (1.0 - done) / done << " s";
+    else line << "unknown";
+    *telemetry.out << line.str() << std::endl;
+  };
+
+  // checkpoint and report loop, until all the workers are done
+  auto after = [](Clock::time_point t, double seconds) {
+    return t + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+  };
+  Clock::time_point next_checkpoint = after(start, checkpoint.interval);
+  Clock::time_point next_report = after(start, telemetry.interval);
+  std::vector<Published> counters;
+  std::vector<Node> snapshot;
+  std::vector<uint8_t> records;
+  while (checkpoints || reports) {
+    {
+      Clock::time_point deadline = checkpoints && reports ? std::min(next_checkpoint, next_report)
+                                   : checkpoints ? next_checkpoint : next_report;
+      std::unique_lock<std::mutex> guard(finished_lock);
+      if (finished_cv.wait_until(guard, deadline, [&]() { return finished.load() == num_threads; })) break;
+    }
+
+    // stop the world, copy the pools and the counters, and let the workers resume
+    pause_requested.store(true);
+    while (paused.load() + finished.load() < num_threads) std::this_thread::yield();
+    Clock::time_point now = Clock::now();
+    counters = published;
+    snapshot.clear();
+    Pool::snapshot(pools, snapshot);
+    pause_requested.store(false);
+    while (paused.load() > 0) std::this_thread::yield();
+
+    // encode and write the snapshot while the workers run
+    if constexpr (has_encode<Problem>::value) {
+      if (checkpoints && now >= next_checkpoint) {
+        CheckpointHeader header = checkpoint.header;
+        header.exploredTree = exploredTree;
+        header.exploredSol = exploredSol;
+        for (const Published& p : counters) {
+          header.exploredTree += p.tree;
+          header.exploredSol += p.sol;
+        }
+        header.record_size = problem.record_size();
+        records.clear();
+        for (const Node& node : snapshot) problem.encode(node, records);
+        // a write that failed (full disk, deleted directory) would fail again: checkpointing
+        // stops, and the last checkpoint written, if any, is the one to resume from
+        if (!write_checkpoint(checkpoint.file, header, records)) {
+          std::cerr << "[ERROR] Checkpoints stopped, the search goes on without them\n";
+          checkpoints = false;
+        }
+        next_checkpoint = after(now, checkpoint.interval);
+      }
+    }
+    if (reports && now >= next_report) {
+      report(counters, snapshot, std::chrono::duration<double>(now - start).count());
+      next_report = after(now, telemetry.interval);
+    }
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // final report, with the idle time of each worker over the whole search
+  if (reports) report(published, std::vector<Node>(), std::chrono::duration<double>(Clock::now() - start).count());
+
+  exploredTree += tree_total.load();
+  exploredSol += sol_total.load();
+  return Pool::footprint(pools);
+}
+
+// loop scheduling of the frontier nodes among the threads (as in OpenMP)
+enum class Schedule {
+  Static,  // one contiguous block of nodes per thread
+  Dynamic, // threads take the next node one at a time
+  Guided   // threads take chunks proportional to the remaining nodes, down to one
+};
+
+// expand the tree breadth-first from `roots` and return the nodes at depth `cutoff` (or the
+// leaves, if they are shallower). The nodes above the cutoff are counted as usual.
+template <typename Problem>
+std::vector<typename Problem::Node> generate_frontier(const Problem& problem, const std::vector<typename Problem::Node>& roots,
+                                                      size_t cutoff, size_t& exploredTree, size_t& exploredSol)
+{
+  using Node = typename Problem::Node;
+  std::vector<Node> frontier;
+  std::queue<Node> pool;
+  for (const Node& root : roots) {
+    pool.push(root);
+  }
+
+  while (pool.size() != 0) {
+    Node currentNode(std::move(pool.front()));
+    pool.pop();
+
+    if (problem.depth(currentNode) >= cutoff || problem.is_leaf(currentNode)) {
+      frontier.push_back(currentNode);
+    }
+    else {
+      evaluate_and_branch(problem, currentNode, pool, exploredTree, exploredSol);
+    }
+  }
+
+  return frontier;
+}
+
+// memory budget of the breadth-first expansions of the hybrid engine (0: no limit)
+struct MemoryBudget {
+  size_t nodes = 1 << 16; // number of open nodes
+  size_t bytes = 0;       // size of the open nodes, in bytes
+
+  // maximum number of open nodes of `node_size` bytes
+  size_t max_nodes(size_t node_size) const {
+    size_t limit = nodes > 0 ? nodes : SIZE_MAX;
+    if (bytes > 0) limit = std::min(limit, std::max<size_t>(1, bytes / node_size));
+    return limit;
+  }
+};
+
+// expand the tree breadth-first from `roots` until `max_nodes` nodes are open (or the tree
+// is exhausted), and return the open nodes. The nodes expanded are counted as usual, and
+// `peak_bytes` is raised to the peak size of the queue. The leaves reached are returned
+// with the open nodes, so that they are counted (and written) by the next phase.
+template <typename Problem>
+std::vector<typename Problem::Node> expand_breadth_first(const Problem& problem, const std::vector<typename Problem::Node>& roots,
+                                                         size_t max_nodes, size_t& exploredTree, size_t& exploredSol,
+                                                         size_t& peak_bytes)
+{
+  using Node = typename Problem::Node;
+  std::queue<Node, SlabDeque<Node>> pool;
+  for (const Node& root : roots) {
+    pool.push(root);
+  }
+
+  std::vector<Node> open;
+  size_t peak = pool.size();
+  while (pool.size() != 0 && pool.size() < max_nodes) {
+    Node currentNode(std::move(pool.front()));
+    pool.pop();
+    if (problem.is_leaf(currentNode)) {
+      open.push_back(currentNode);
+      continue;
+    }
+    evaluate_and_branch(problem, currentNode, pool, exploredTree, exploredSol);
+    peak = std::max(peak, pool.size());
+  }
+  peak_bytes = std::max(peak_bytes, peak * sizeof(Node));
+
+  open.reserve(open.size() + pool.size());
+  while (pool.size() != 0) {
+    open.push_back(pool.front());
+    pool.pop();
+  }
+  return open;
+}
+
+// solve the subtrees rooted at the frontier nodes with a parallel-for over `num_threads`
+// threads, each running its own sequential DFS. The busy time of each thread is stored in
+// `busy_ms`, to measure the load balance. With a stream, each thread writes its solutions
+// through its own writer, until the stream asks to stop.
+template <typename Problem>
+void solve_frontier(const Problem& problem, const std::vector<typename Problem::Node>& frontier, size_t num_threads,
+                    Schedule schedule, size_t& exploredTree, size_t& exploredSol, std::vector<double>& busy_ms,
+                    SolutionStream* solutions = nullptr)
+{
+  const size_t M = frontier.size();
+  std::atomic<size_t> next{0}; // first frontier node not claimed yet (dynamic/guided)
+  std::atomic<size_t> tree_total{0};
+  std::atomic<size_t> sol_total{0};
+  busy_ms.assign(num_threads, 0.0);
+
+  // get the next range [begin, end) of frontier nodes to solve by thread `id`
+  auto next_chunk = [&](size_t id, bool& first, size_t& begin, size_t& end) {
+    switch (schedule) {
+      case Schedule::Static:
+        if (!first) return false;
+        first = false;
+        begin = id * M / num_threads;
+        end = (id + 1) * M / num_threads;
+        return true;
+      case Schedule::Dynamic:
+        begin = next.fetch_add(1);
+        end = begin + 1;
+        return begin < M;
+      case Schedule::Guided:
+        begin = next.load();
+        do {
+          if (begin >= M) return false;
+          end = begin + std::max<size_t>(1, (M - begin) / (2 * num_threads));
+        } while (!next.compare_exchange_weak(begin, end));
+        return true;
+    }
+    return false;
+  };
+
+  auto worker = [&](size_t id) {
+    auto start = std::chrono::steady_clock::now();
+    size_t tree_loc = 0;
+    size_t num_sol = 0;
+    NodeStack<typename Problem::Node> pool;
+    size_t begin = 0, end = 0;
+    bool first = true;
+    std::unique_ptr<SolutionStream::Writer> out;
+    if (solutions != nullptr) out.reset(new SolutionStream::Writer(*solutions));
+
+    while (!(out != nullptr && out->stopped()) && next_chunk(id, first, begin, end)) {
+      for (size_t i = begin; i < end; i++) {
+        pool.push(frontier[i]);
+        dfs(problem, pool, tree_loc, num_sol, out.get());
+      }
+    }
+    out.reset();
+
+    tree_total.fetch_add(tree_loc);
+    sol_total.fetch_add(num_sol);
+    busy_ms[id] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < num_threads; id++) {
+    threads.emplace_back(worker, id);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  exploredTree += tree_total.load();
+  exploredSol += sol_total.load();
+}
+
+// parallel best-first search: the workers share one priority queue of the open nodes and
+// always branch the node of highest priority. The queue is locked for each node taken and
+// for the children of each node pushed back, which is cheap next to problems whose nodes
+// are costly to evaluate (e.g. bounded by an incumbent). The search ends when the queue is
+// empty and no worker is branching a node (which could refill it). The queue is not
+// bounded: it may hold a whole level of the tree.
+template <typename Problem>
+void best_first(const Problem& problem, const std::vector<typename Problem::Node>& roots, size_t num_threads,
+                size_t& exploredTree, size_t& exploredSol, SolutionStream* solutions = nullptr)
+{
+  using Node = typename Problem::Node;
+  struct Entry {
+    double priority;
+    Node node;
+    bool operator<(const Entry& other) const {return priority < other.priority;}
+  };
+  // children of a node, pushed to the queue at once
+  struct Children {
+    std::vector<Node> nodes;
+    inline void push(const Node& node){nodes.push_back(node);}
+  };
+
+  std::priority_queue<Entry> queue;
+  std::mutex lock;
+  std::condition_variable changed;
+  size_t busy = 0; // workers branching a node
+  std::atomic<size_t> tree_total{0};
+  std::atomic<size_t> sol_total{0};
+  for (const Node& root : roots) {
+    queue.push(Entry{problem.priority(root), root});
+  }
+
+  auto worker = [&]() {
+    size_t tree_loc = 0;
+    size_t num_sol = 0;
+    Children children;
+    std::unique_ptr<SolutionStream::Writer> out;
+    if (solutions != nullptr) out.reset(new SolutionStream::Writer(*solutions));
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+      changed.wait(guard, [&]() { return !queue.empty() || busy == 0; });
+      if (queue.empty() || (out != nullptr && out->stopped())) break;
+      Node currentNode(queue.top().node);
+      queue.pop();
+      busy++;
+      guard.unlock();
+
+      children.nodes.clear();
+      evaluate_and_branch(problem, currentNode, children, tree_loc, num_sol, out.get());
+
+      guard.lock();
+      for (const Node& child : children.nodes) {
+        queue.push(Entry{problem.priority(child), child});
+      }
+      busy--;
+      changed.notify_all();
+    }
+    changed.notify_all();
+    guard.unlock();
+    out.reset();
+
+    tree_total.fetch_add(tree_loc);
+    sol_total.fetch_add(num_sol);
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < num_threads; id++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  exploredTree += tree_total.load();
+  exploredSol += sol_total.load();
+}
+
+// search engines
+enum class Engine {
+  Sequential,   // sequential DFS
+  WorkStealing, // DFS with one deque per worker and work stealing
+  Frontier,     // breadth-first frontier, then a parallel-for over its subtrees
+  Hybrid,       // breadth-first within a memory budget, then work-stealing DFS
+  BestFirst     // shared priority queue of the open nodes
+};
+
+// options of the engines
+struct EngineConfig {
+  Engine engine = Engine::Sequential;
+  size_t num_threads = 1;       // number of workers (parallel engines)
+  size_t cutoff = 4;            // depth of the frontier (frontier engine)
+  Schedule schedule = Schedule::Dynamic; // loop schedule (frontier engine)
+  PoolKind pool = PoolKind::Locked;      // pools of the workers (work-stealing and hybrid engines)
+  CheckpointConfig checkpoint;  // checkpoints (work-stealing and hybrid engines)
+  TelemetryConfig telemetry;    // progress reports (work-stealing and hybrid engines)
+  MemoryBudget budget;          // open nodes of the breadth-first expansions (hybrid engine)
+  SolutionStream* solutions = nullptr; // stream the solutions are written to (nullptr: none)
+};
+
+// statistics of a search
+struct EngineStats {
+  size_t exploredTree = 0;      // number of nodes generated
+  size_t exploredSol = 0;       // number of leaves reached
+  size_t frontierSize = 0;      // number of frontier nodes (frontier and hybrid engines)
+  std::vector<double> busy_ms;  // busy time of each thread (frontier engine)
+  size_t peak_pool_bytes = 0;   // peak footprint of the pools of nodes (work-stealing and hybrid engines)
+};
+
+// explore the trees rooted at `roots` with the engine of `config`, adding to the counters of `stats`
+template <typename Problem>
+void backtrack(const Problem& problem, const std::vector<typename Problem::Node>& roots, const EngineConfig& config,
+               EngineStats& stats)
+{
+  using Node = typename Problem::Node;
+  if constexpr (!has_write_solution<Problem>::value) {
+    if (config.solutions != nullptr) throw std::invalid_argument("this problem does not support writing its solutions");
+  }
+  switch (config.engine) {
+    case Engine::Sequential: {
+      // initialization of the pool of nodes (stack -> DFS exploration order)
+      NodeStack<Node> pool;
+      for (const Node& root : roots) {
+        pool.push(root);
+      }
+      std::unique_ptr<SolutionStream::Writer> out;
+      if (config.solutions != nullptr) out.reset(new SolutionStream::Writer(*config.solutions));
+      dfs(problem, pool, stats.exploredTree, stats.exploredSol, out.get());
+      break;
+    }
+    case Engine::WorkStealing: {
+      with_pool<Node>(config.pool, [&](auto tag) {
+        using Pool = typename decltype(tag)::type;
+        size_t bytes = parallel_dfs<Pool>(problem, roots, config.num_threads, stats.exploredTree, stats.exploredSol,
+                                          config.checkpoint, config.telemetry, 0, config.solutions);
+        stats.peak_pool_bytes = std::max(stats.peak_pool_bytes, bytes);
+      });
+      break;
+    }
+    case Engine::Frontier: {
+      std::vector<Node> frontier = generate_frontier(problem, roots, config.cutoff, stats.exploredTree, stats.exploredSol);
+      stats.frontierSize = frontier.size();
+      solve_frontier(problem, frontier, config.num_threads, config.schedule, stats.exploredTree, stats.exploredSol, stats.busy_ms,
+                     config.solutions);
+      break;
+    }
+    case Engine::Hybrid: {
+      // breadth-first until the budget is reached, then depth-first in each worker, with
+      // the budget shared between the workers for the breadth-first fallback
+      const size_t max_nodes = config.budget.max_nodes(sizeof(Node));
+      std::vector<Node> open = expand_breadth_first(problem, roots, max_nodes, stats.exploredTree, stats.exploredSol,
+                                                    stats.peak_pool_bytes);
+      stats.frontierSize = open.size();
+      with_pool<Node>(config.pool, [&](auto tag) {
+        using Pool = typename decltype(tag)::type;
+        size_t bytes = parallel_dfs<Pool>(problem, open, config.num_threads, stats.exploredTree, stats.exploredSol,
+                                          config.checkpoint, config.telemetry,
+                                          std::max<size_t>(1, max_nodes / config.num_threads), config.solutions);
+        stats.peak_pool_bytes = std::max(stats.peak_pool_bytes, bytes);
+      });
+      break;
+    }
+    case Engine::BestFirst: {
+      if constexpr (has_priority<Problem>::value) {
+        best_first(problem, roots, config.num_threads, stats.exploredTree, stats.exploredSol, config.solutions);
+      }
+      else {
+        throw std::invalid_argument("this problem does not support the best-first search");
+      }
+      break;
+    }
+  }
+}
+
+// peak resident set size of the process, in kilobytes
+inline size_t peak_memory_kb()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+#endif
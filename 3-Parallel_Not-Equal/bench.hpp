@@ -0,0 +1,133 @@
+#ifndef PARALLEL_NOT_EQUAL_BENCH_HPP
+#define PARALLEL_NOT_EQUAL_BENCH_HPP
+
+// Helpers shared by the benchmarks (bench_*.cpp): parsing of the list options, summary of
+// the times of repeated runs, and the report, a table written as CSV or JSON.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cmath>
+#include <algorithm>
+
+// parts of `s` between the `delimiter`s, without the empty ones
+inline std::vector<std::string> split(const std::string& s, char delimiter)
+{
+  std::vector<std::string> parts;
+  std::stringstream ss(s);
+  std::string part;
+  while (std::getline(ss, part, delimiter)) {
+    if (!part.empty()) parts.push_back(part);
+  }
+  return parts;
+}
+
+// summary of the times of repeated runs, in milliseconds
+struct Timings {
+  double median_ms = 0.0;
+  double min_ms = 0.0;
+  double stddev_ms = 0.0;
+};
+
+inline Timings summarize(std::vector<double> times)
+{
+  Timings timings;
+  const size_t k = times.size();
+  if (k == 0) return timings;
+  std::sort(times.begin(), times.end());
+  double mean = 0.0;
+  for (double t : times) mean += t / k;
+  double variance = 0.0;
+  for (double t : times) variance += (t - mean) * (t - mean) / k;
+  timings.median_ms = k % 2 == 1 ? times[k / 2] : (times[k / 2 - 1] + times[k / 2]) / 2;
+  timings.min_ms = times.front();
+  timings.stddev_ms = std::sqrt(variance);
+  return timings;
+}
+
+// format of a report
+enum class ReportFormat { Csv, Json };
+
+inline bool parse_format(const std::string& name, ReportFormat& format)
+{
+  if (name == "csv") format = ReportFormat::Csv;
+  else if (name == "json") format = ReportFormat::Json;
+  else return false;
+  return true;
+}
+
+// table of results: one row per line of the CSV or object of the JSON array, with a field
+// per column. The fields are added in the order of the columns, after `row()`.
+struct Report {
+  std::vector<std::string> columns;
+  std::vector<std::vector<std::pair<std::string, bool>>> rows; // text of each field, quoted in JSON
+
+  explicit Report(std::vector<std::string> columns) : columns(std::move(columns)) {}
+
+  Report& row() {
+    rows.emplace_back();
+    return *this;
+  }
+  template <typename T>
+  Report& add(const T& value) {
+    std::ostringstream text;
+    text << value;
+    rows.back().emplace_back(text.str(), false);
+    return *this;
+  }
+  Report& add(const std::string& value) {
+    rows.back().emplace_back(value, true);
+    return *this;
+  }
+  Report& add(bool value) {
+    rows.back().emplace_back(value ? "true" : "false", false);
+    return *this;
+  }
+
+  void write(std::ostream& out, ReportFormat format) const {
+    if (format == ReportFormat::Json) {
+      out << "[\n";
+      for (size_t i = 0; i < rows.size(); i++) {
+        out << "  {";
+        for (size_t c = 0; c < rows[i].size(); c++) {
+          const std::pair<std::string, bool>& field = rows[i][c];
+          out << (c > 0 ? ", " : "") << "\"" << columns[c] << "\": ";
+          if (field.second) out << "\"" << field.first << "\"";
+          else out << field.first;
+        }
+        out << "}" << (i + 1 < rows.size() ? ",\n" : "\n");
+      }
+      out << "]\n";
+    }
+    else {
+      for (size_t c = 0; c < columns.size(); c++) out << (c > 0 ? "," : "") << columns[c];
+      out << "\n";
+      for (const std::vector<std::pair<std::string, bool>>& fields : rows) {
+        for (size_t c = 0; c < fields.size(); c++) out << (c > 0 ? "," : "") << fields[c].first;
+        out << "\n";
+      }
+    }
+  }
+};
+
+// write `report` to the file `output`, or to the standard output if it is empty; false if
+// the file cannot be opened
+inline bool write_report(const Report& report, ReportFormat format, const std::string& output)
+{
+  if (output.empty()) {
+    report.write(std::cout, format);
+    return true;
+  }
+  std::ofstream file(output);
+  if (!file.is_open()) {
+    std::cerr << "[ERROR] Couldn't open " << output << std::endl;
+    return false;
+  }
+  report.write(file, format);
+  return true;
+}
+
+#endif
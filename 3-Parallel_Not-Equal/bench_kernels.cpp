@@ -0,0 +1,155 @@
+/*
+ * Description:
+ * Benchmark of the kernels evaluating the children of a node (see nqueens.hpp). For each N,
+ * the sequential DFS is run with each kernel, and the gain of each kernel over the scalar
+ * one, whose loops depend on N at runtime, is reported as CSV or JSON.
+ *
+ * usage: bench_kernels [--n 8-16] [--kernels scalar,fixed,sse,avx2] [--repeat 5]
+ *                      [--format csv|json] [--output FILE]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "nqueens.hpp"
+#include "bench.hpp"
+
+// one line of the report: the repeated runs of a kernel for a given N
+struct KernelRow {
+  size_t N;
+  std::string kernel;
+  size_t repeat;
+  double median_ms;
+  double min_ms;
+  double nodes_per_sec; // median run
+  size_t tree;
+  double gain;          // median time of the scalar kernel divided by the median time
+};
+
+// run the sequential DFS of `N` queens with `kernel` `repeat` times and summarize the timings
+KernelRow run(size_t N, KernelKind kernel, size_t repeat)
+{
+  SearchConfig config;
+  config.N = N;
+  config.kernel = kernel;
+  std::vector<double> times;
+  SearchResult result;
+
+  for (size_t r = 0; r < repeat; r++) {
+    auto start = std::chrono::steady_clock::now();
+    result = solve(config);
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  const Timings timings = summarize(times);
+
+  KernelRow row;
+  row.N = N;
+  row.kernel = kernel_name(kernel);
+  row.repeat = repeat;
+  row.median_ms = timings.median_ms;
+  row.min_ms = timings.min_ms;
+  row.nodes_per_sec = row.median_ms > 0.0 ? result.rawTree / (row.median_ms / 1000.0) : 0.0;
+  row.tree = result.exploredTree;
+  row.gain = 1.0;
+  return row;
+}
+
+int main(int argc, char** argv) {
+  // options
+  size_t n_min = 8, n_max = 16;
+  std::vector<std::string> kernels = {"scalar", "fixed", "sse", "avx2"};
+  size_t repeat = 5;
+  ReportFormat format = ReportFormat::Csv;
+  std::string output;
+
+  for (int i = 1; i < argc; i++) {
+    std::string option(argv[i]);
+    if (i + 1 == argc) {
+      std::cerr << "[ERROR] missing value for " << option << std::endl;
+      return 1;
+    }
+    std::string value(argv[++i]);
+    if (option == "--n") {
+      std::vector<std::string> range = split(value, '-');
+      n_min = std::stoll(range.front());
+      n_max = std::stoll(range.back());
+    }
+    else if (option == "--kernels") kernels = split(value, ',');
+    else if (option == "--repeat") repeat = std::max<size_t>(1, std::stoll(value));
+    else if (option == "--format") {
+      if (!parse_format(value, format)) {
+        std::cerr << "[ERROR] unknown format " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (option == "--output") output = value;
+    else {
+      std::cerr << "[ERROR] unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+  if (n_max > MAX_N) {
+    std::cerr << "[ERROR] at most " << MAX_N << " queens are supported" << std::endl;
+    return 1;
+  }
+
+  std::vector<KernelKind> kinds;
+  for (const std::string& name : kernels) {
+    if (name == "scalar") kinds.push_back(KernelKind::Scalar);
+    else if (name == "fixed") kinds.push_back(KernelKind::Fixed);
+    else if (name == "sse") kinds.push_back(KernelKind::Sse);
+    else if (name == "avx2") kinds.push_back(KernelKind::Avx2);
+    else {
+      std::cerr << "[ERROR] unknown kernel " << name << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<KernelRow> rows;
+  bool all_correct = true;
+
+  for (size_t N = n_min; N <= n_max; N++) {
+    // baseline: scalar kernel, used for the gains and to check the tree size
+    std::cerr << "N=" << N << " scalar" << std::endl;
+    KernelRow baseline = run(N, KernelKind::Scalar, repeat);
+
+    for (KernelKind kind : kinds) {
+      if (kind == KernelKind::Scalar) {
+        rows.push_back(baseline);
+        continue;
+      }
+      KernelKind resolved;
+      try {
+        resolved = resolve_kernel(kind, N);
+      }
+      catch (const std::exception& e) {
+        std::cerr << "[WARNING] " << e.what() << ", skipped" << std::endl;
+        continue;
+      }
+      // without a specialized kernel for this N, `fixed` is the scalar kernel
+      if (resolved != kind) continue;
+
+      std::cerr << "N=" << N << " " << kernel_name(kind) << std::endl;
+      KernelRow row = run(N, kind, repeat);
+      row.gain = row.median_ms > 0.0 ? baseline.median_ms / row.median_ms : 0.0;
+      if (row.tree != baseline.tree) {
+        std::cerr << "[ERROR] wrong tree size for N=" << N << " with the " << row.kernel
+                  << " kernel: " << row.tree << " nodes" << std::endl;
+        all_correct = false;
+      }
+      rows.push_back(row);
+    }
+  }
+
+  Report report({"N", "kernel", "repeat", "median_ms", "min_ms", "nodes_per_sec", "tree", "gain"});
+  for (const KernelRow& row : rows) {
+    report.row().add(row.N).add(row.kernel).add(row.repeat).add(row.median_ms).add(row.min_ms)
+      .add(row.nodes_per_sec).add(row.tree).add(row.gain);
+  }
+  if (!write_report(report, format, output)) return 1;
+
+  return all_correct ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+/*
+ * Description:
+ * Benchmark harness for the N-Queens tree-search engines of nqueens.hpp. It sweeps a range
+ * of N, the engines and the thread counts, repeats each run, checks the number of solutions
+ * against the known counts, and reports the timings as CSV or JSON.
+ *
+ * usage: bench_nqueens [--n 8-14] [--engines seq,ws,frontier,hybrid] [--threads 1,2,4,8]
+ *                      [--repeat 5] [--cutoff 4] [--schedule dynamic] [--budget-nodes 65536] [--symmetry]
+ *                      [--kernel auto|scalar|fixed|sse|avx2] [--pool locked|chase-lev|global]
+ *                      [--format csv|json] [--output FILE]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "nqueens.hpp"
+#include "bench.hpp"
+
+// number of solutions of the N-Queens problem, for N = 0..27 (OEIS A000170)
+const size_t KNOWN_SOLUTIONS[] = {
+  1, 1, 0, 0, 2, 10, 4, 40, 92, 352, 724, 2680, 14200, 73712, 365596, 2279184, 14772512,
+  95815104, 666090624, 4968057848, 39029188884, 314666222712, 2691008701644,
+  24233937684440, 227514171973736, 2207893435808352, 22317699616364044,
+  234907967154122528
+};
+const size_t NUM_KNOWN = sizeof(KNOWN_SOLUTIONS) / sizeof(KNOWN_SOLUTIONS[0]);
+
+// one line of the report: the repeated runs of an engine for a given N and thread count
+struct BenchRow {
+  size_t N;
+  std::string engine;
+  std::string kernel;
+  size_t threads;
+  size_t repeat;
+  double median_ms;
+  double min_ms;
+  double stddev_ms;
+  double nodes_per_sec; // nodes actually explored per second (median run)
+  size_t solutions;
+  size_t tree;
+  bool correct;         // solutions match the known count and the tree matches the baseline
+  double speedup;       // median time of the sequential DFS divided by the median time
+  double efficiency;    // speedup divided by the number of threads
+};
+
+// run `config` `repeat` times and summarize the timings
+BenchRow run(const SearchConfig& config, const std::string& engine, size_t repeat)
+{
+  std::vector<double> times;
+  SearchResult result;
+
+  for (size_t r = 0; r < repeat; r++) {
+    auto start = std::chrono::steady_clock::now();
+    result = solve(config);
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  const Timings timings = summarize(times);
+
+  BenchRow row;
+  row.N = config.N;
+  row.engine = engine;
+  row.kernel = kernel_name(result.kernel);
+  row.threads = config.engine == Engine::Sequential ? 1 : config.num_threads;
+  row.repeat = repeat;
+  row.median_ms = timings.median_ms;
+  row.min_ms = timings.min_ms;
+  row.stddev_ms = timings.stddev_ms;
+  row.nodes_per_sec = row.median_ms > 0.0 ? result.rawTree / (row.median_ms / 1000.0) : 0.0;
+  row.solutions = result.exploredSol;
+  row.tree = result.exploredTree;
+  row.correct = config.N >= NUM_KNOWN || result.exploredSol == KNOWN_SOLUTIONS[config.N];
+  row.speedup = 1.0;
+  row.efficiency = 1.0;
+  return row;
+}
+
+// table of the report
+Report report(const std::vector<BenchRow>& rows)
+{
+  Report report({"N", "engine", "kernel", "threads", "repeat", "median_ms", "min_ms", "stddev_ms", "nodes_per_sec",
+                 "solutions", "tree", "correct", "speedup", "efficiency"});
+  for (const BenchRow& row : rows) {
+    report.row().add(row.N).add(row.engine).add(row.kernel).add(row.threads).add(row.repeat)
+      .add(row.median_ms).add(row.min_ms).add(row.stddev_ms).add(row.nodes_per_sec)
+      .add(row.solutions).add(row.tree).add(row.correct).add(row.speedup).add(row.efficiency);
+  }
+  return report;
+}
+
+int main(int argc, char** argv) {
+  // options
+  size_t n_min = 8, n_max = 14;
+  std::vector<std::string> engines = {"seq", "ws", "frontier"};
+  std::vector<size_t> thread_counts = {1, 2, 4};
+  size_t repeat = 5;
+  SearchConfig base;
+  ReportFormat format = ReportFormat::Csv;
+  std::string output;
+
+  for (int i = 1; i < argc; i++) {
+    std::string option(argv[i]);
+    if (option == "--symmetry") {
+      base.symmetry = true;
+      continue;
+    }
+    if (i + 1 == argc) {
+      std::cerr << "[ERROR] missing value for " << option << std::endl;
+      return 1;
+    }
+    std::string value(argv[++i]);
+    if (option == "--n") {
+      std::vector<std::string> range = split(value, '-');
+      n_min = std::stoll(range.front());
+      n_max = std::stoll(range.back());
+    }
+    else if (option == "--engines") engines = split(value, ',');
+    else if (option == "--threads") {
+      thread_counts.clear();
+      for (const std::string& t : split(value, ',')) thread_counts.push_back(std::stoll(t));
+    }
+    else if (option == "--repeat") repeat = std::max<size_t>(1, std::stoll(value));
+    else if (option == "--cutoff") base.cutoff = std::stoll(value);
+    else if (option == "--budget-nodes") base.budget.nodes = std::stoll(value);
+    else if (option == "--schedule") {
+      if (value == "static") base.schedule = Schedule::Static;
+      else if (value == "dynamic") base.schedule = Schedule::Dynamic;
+      else if (value == "guided") base.schedule = Schedule::Guided;
+      else {
+        std::cerr << "[ERROR] unknown schedule " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (option == "--kernel") {
+      if (value == "auto") base.kernel = KernelKind::Auto;
+      else if (value == "scalar") base.kernel = KernelKind::Scalar;
+      else if (value == "fixed") base.kernel = KernelKind::Fixed;
+      else if (value == "sse") base.kernel = KernelKind::Sse;
+      else if (value == "avx2") base.kernel = KernelKind::Avx2;
+      else {
+        std::cerr << "[ERROR] unknown kernel " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (option == "--pool") {
+      if (!parse_pool(value, base.pool)) {
+        std::cerr << "[ERROR] unknown pool " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (option == "--format") {
+      if (!parse_format(value, format)) {
+        std::cerr << "[ERROR] unknown format " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (option == "--output") output = value;
+    else {
+      std::cerr << "[ERROR] unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+  if (n_max > MAX_N) {
+    std::cerr << "[ERROR] at most " << MAX_N << " queens are supported" << std::endl;
+    return 1;
+  }
+
+  std::vector<BenchRow> rows;
+  bool all_correct = true;
+
+  for (size_t N = n_min; N <= n_max; N++) {
+    // baseline: sequential DFS, used for the speedups and to check the tree size
+    SearchConfig config = base;
+    config.N = N;
+    config.engine = Engine::Sequential;
+    try {
+      config.kernel = resolve_kernel(base.kernel, N);
+    }
+    catch (const std::exception& e) {
+      std::cerr << "[ERROR] " << e.what() << std::endl;
+      return 1;
+    }
+    std::cerr << "N=" << N << " seq" << std::endl;
+    BenchRow baseline = run(config, "seq", repeat);
+
+    for (const std::string& engine : engines) {
+      if (engine == "seq") {
+        rows.push_back(baseline);
+        continue;
+      }
+      if (engine == "ws") config.engine = Engine::WorkStealing;
+      else if (engine == "frontier") config.engine = Engine::Frontier;
+      else if (engine == "hybrid") config.engine = Engine::Hybrid;
+      else {
+        std::cerr << "[ERROR] unknown engine " << engine << std::endl;
+        return 1;
+      }
+
+      for (size_t threads : thread_counts) {
+        config.num_threads = threads;
+        std::cerr << "N=" << N << " " << engine << " threads=" << threads << std::endl;
+        BenchRow row = run(config, engine, repeat);
+        row.correct = row.correct && row.tree == baseline.tree;
+        row.speedup = row.median_ms > 0.0 ? baseline.median_ms / row.median_ms : 0.0;
+        row.efficiency = row.speedup / threads;
+        rows.push_back(row);
+      }
+    }
+  }
+
+  for (const BenchRow& row : rows) {
+    if (!row.correct) {
+      std::cerr << "[ERROR] wrong result for N=" << row.N << " with " << row.engine
+                << " (" << row.threads << " threads): " << row.solutions << " solutions, "
+                << row.tree << " nodes" << std::endl;
+      all_correct = false;
+    }
+  }
+
+  if (!write_report(report(rows), format, output)) return 1;
+
+  return all_correct ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+/*
+ * Description:
+ * Benchmark of the instance loader of parser.hpp. Each file is read `repeat` times with
+ * `Data::read_input` (memory-mapped, one pass) and with the original line-by-line parser
+ * (std::getline and a std::stringstream per entry), kept here as the baseline. With
+ * `--threads K`, it is also read by `Data::read_input` with K threads (loader "mmap-K").
+ * The instances read are compared, and the throughputs are reported as CSV or JSON.
+ * Binary instances are only read by `Data::read_input`.
+ *
+ * usage: bench_parser FILE... [--repeat 3] [--threads K] [--no-baseline] [--format csv|json] [--output FILE]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "parser.hpp"
+#include "bench.hpp"
+
+// one line of the report: the repeated reads of a file by a loader
+struct ParserRow {
+  std::string file;
+  std::string loader;
+  size_t bytes;
+  size_t n;
+  size_t repeat;
+  double median_ms;
+  double mb_per_s;  // median run
+  bool correct;     // same instance as the baseline
+};
+
+// instance read by the original parser of parser.hpp
+struct BaselineData {
+  size_t n = 0;
+  std::vector<int> u;
+  std::vector<int> C; // row-major
+};
+
+bool baseline_read(const std::string& filename, BaselineData& data)
+{
+  std::ifstream f(filename);
+  if (!f.is_open()) {
+    std::cerr << "[ERROR] Couldn't open " << filename << "\n";
+    return false;
+  }
+
+  std::string s;
+  std::string current;
+  std::string delimiter1 = ";";
+  std::string delimiter2 = ",";
+  while (std::getline(f, s)) {
+    if (s == "N" || s == "U" || s == "C") {
+      current = s;
+      continue;
+    }
+    if (current == "N") {
+      // the lines that are not numbers (e.g. the `n` of pco_3.txt) are skipped: the
+      // original parser read them as a size of 0
+      std::stringstream ss(s);
+      size_t n;
+      if (ss >> n) {
+        data.n = n;
+        data.u.assign(n, 0);
+        data.C.assign(n * n, 0);
+      }
+    }
+    if (current == "U") {
+      size_t delimiter_id = s.find(delimiter1);
+      std::string s_id = s.substr(0, delimiter_id);
+      std::string s_value = s.substr(delimiter_id + 1, s.size());
+
+      std::stringstream ss(s_id);
+      size_t i;
+      ss >> i;
+      data.u[i] = std::stoi(s_value);
+    }
+    if (current == "C") {
+      size_t delimiter_id1 = s.find(delimiter1);
+      std::string s_id = s.substr(0, delimiter_id1);
+      std::string s_value = s.substr(delimiter_id1 + 1, s.size());
+
+      size_t delimiter_id2 = s_id.find(delimiter2);
+      std::string si = s_id.substr(0, delimiter_id2);
+      std::string sj = s_id.substr(delimiter_id2 + 1, s_id.size());
+
+      size_t sti, stj;
+      std::stringstream ss1(si);
+      ss1 >> sti;
+      std::stringstream ss2(sj);
+      ss2 >> stj;
+      data.C[sti * data.n + stj] = std::stoi(s_value);
+    }
+  }
+  return true;
+}
+
+bool same_instance(Data& data, const BaselineData& baseline)
+{
+  if (data.get_n() != baseline.n) return false;
+  for (size_t i = 0; i < baseline.n; i++) {
+    if (data.get_u_at(i) != baseline.u[i]) return false;
+    for (size_t j = 0; j < baseline.n; j++) {
+      // the bitset keeps whether an entry is in C (non-zero)
+      if (data.get_C_at(i, j) != (baseline.C[i * baseline.n + j] != 0)) return false;
+    }
+  }
+  return true;
+}
+
+bool same_instance(Data& data, Data& other)
+{
+  if (data.get_n() != other.get_n()) return false;
+  for (size_t i = 0; i < data.get_n(); i++) {
+    if (data.get_u_at(i) != other.get_u_at(i)) return false;
+    if (std::memcmp(data.get_C_row(i), other.get_C_row(i), data.get_words_per_row() * sizeof(uint64_t)) != 0) return false;
+  }
+  return true;
+}
+
+// whether `filename` is an instance in the binary format
+bool is_binary(const std::string& filename)
+{
+  std::ifstream f(filename, std::ios::binary);
+  char magic[sizeof(INSTANCE_MAGIC)] = {};
+  f.read(magic, sizeof(magic));
+  return f && std::memcmp(magic, INSTANCE_MAGIC, sizeof(magic)) == 0;
+}
+
+int main(int argc, char** argv) {
+  // options
+  std::vector<std::string> files;
+  size_t repeat = 3;
+  size_t num_threads = 1;
+  bool baseline = true;
+  ReportFormat format = ReportFormat::Csv;
+  std::string output;
+
+  for (int i = 1; i < argc; i++) {
+    std::string option(argv[i]);
+    if (option.compare(0, 2, "--") != 0) {
+      files.push_back(option);
+      continue;
+    }
+    if (option == "--no-baseline") {
+      baseline = false;
+      continue;
+    }
+    if (i + 1 == argc) {
+      std::cerr << "[ERROR] missing value for " << option << std::endl;
+      return 1;
+    }
+    std::string value(argv[++i]);
+    if (option == "--repeat") repeat = std::max<size_t>(1, std::stoll(value));
+    else if (option == "--threads") num_threads = std::max<size_t>(1, std::stoll(value));
+    else if (option == "--format") {
+      if (!parse_format(value, format)) {
+        std::cerr << "[ERROR] unknown format " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (option == "--output") output = value;
+    else {
+      std::cerr << "[ERROR] unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+  if (files.empty()) {
+    std::cerr << "usage: " << argv[0] << " FILE... [--repeat 3] [--threads K] [--no-baseline] [--format csv|json] [--output FILE]" << std::endl;
+    return 1;
+  }
+
+  std::vector<ParserRow> rows;
+  bool all_correct = true;
+
+  for (const std::string& file : files) {
+    std::cerr << file << " mmap" << std::endl;
+    Data data;
+    std::vector<double> times;
+    for (size_t r = 0; r < repeat; r++) {
+      if (!data.read_input(file, 1)) return 1;
+      times.push_back(1000.0 * data.get_read_seconds());
+    }
+    ParserRow row{file, "mmap", data.get_bytes_read(), data.get_n(), repeat, summarize(times).median_ms, 0.0, true};
+    row.mb_per_s = row.median_ms > 0.0 ? row.bytes / (row.median_ms / 1000.0) / 1e6 : 0.0;
+
+    if (baseline && !is_binary(file)) {
+      std::cerr << file << " getline" << std::endl;
+      BaselineData reference;
+      std::vector<double> baseline_times;
+      for (size_t r = 0; r < repeat; r++) {
+        reference = BaselineData();
+        auto start = std::chrono::steady_clock::now();
+        if (!baseline_read(file, reference)) return 1;
+        baseline_times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+      }
+      row.correct = same_instance(data, reference);
+      if (!row.correct) {
+        std::cerr << "[ERROR] " << file << " is read differently by the two loaders" << std::endl;
+        all_correct = false;
+      }
+      ParserRow base{file, "getline", row.bytes, reference.n, repeat, summarize(baseline_times).median_ms, 0.0, row.correct};
+      base.mb_per_s = base.median_ms > 0.0 ? base.bytes / (base.median_ms / 1000.0) / 1e6 : 0.0;
+      rows.push_back(base);
+    }
+    rows.push_back(row);
+
+    if (num_threads > 1) {
+      const std::string loader = "mmap-" + std::to_string(num_threads);
+      std::cerr << file << " " << loader << std::endl;
+      Data parallel;
+      std::vector<double> parallel_times;
+      for (size_t r = 0; r < repeat; r++) {
+        if (!parallel.read_input(file, num_threads)) return 1;
+        parallel_times.push_back(1000.0 * parallel.get_read_seconds());
+      }
+      ParserRow prow{file, loader, parallel.get_bytes_read(), parallel.get_n(), repeat, summarize(parallel_times).median_ms, 0.0,
+                     same_instance(parallel, data)};
+      prow.mb_per_s = prow.median_ms > 0.0 ? prow.bytes / (prow.median_ms / 1000.0) / 1e6 : 0.0;
+      if (!prow.correct) {
+        std::cerr << "[ERROR] " << file << " is read differently with " << num_threads << " threads" << std::endl;
+        all_correct = false;
+      }
+      rows.push_back(prow);
+    }
+  }
+
+  Report report({"file", "loader", "bytes", "n", "repeat", "median_ms", "mb_per_s", "correct"});
+  for (const ParserRow& row : rows) {
+    report.row().add(row.file).add(row.loader).add(row.bytes).add(row.n).add(row.repeat).add(row.median_ms)
+      .add(row.mb_per_s).add(row.correct);
+  }
+  if (!write_report(report, format, output)) return 1;
+
+  return all_correct ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/*
+ * Description:
+ * Microbenchmark of the node pools of pool.hpp under contention. Each of the K threads owns
+ * a pool prefilled with a backlog of N-Queens nodes, and repeatedly pushes then pops a batch
+ * of nodes, as the DFS loop does. Every few batches, it tries to steal a node from a random
+ * other pool and pushes it into its own, as an idle worker does. The throughput of the
+ * push, pop and steal operations is reported as CSV or JSON, for each pool and thread count.
+ *
+ * usage: bench_pool [--pools sequential,locked,chase-lev,global] [--threads 1,2,4,8]
+ *                   [--duration 0.5] [--batch 8] [--backlog 64] [--steal-every 4]
+ *                   [--format csv|json] [--output FILE]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <atomic>
+
+#include "nqueens.hpp"
+#include "bench.hpp"
+
+// one line of the report: a pool kind with a given number of threads
+struct PoolRow {
+  std::string pool;
+  size_t threads;
+  double seconds;
+  size_t pushes;
+  size_t pops;          // successful pops
+  size_t steal_attempts;
+  size_t steals;        // successful steals
+  double mops_per_sec;  // millions of operations (pushes, pops and steal attempts) per second
+};
+
+// parameters of a run
+struct PoolBench {
+  double duration = 0.5;
+  size_t batch = 8;
+  size_t backlog = 64;
+  size_t steal_every = 4; // batches between two steal attempts
+};
+
+// run `num_threads` threads on pools of type `Pool` for `bench.duration` seconds
+template <typename Pool>
+PoolRow run(const PoolBench& bench, size_t num_threads)
+{
+  std::vector<Pool> pools(num_threads);
+  Pool::share(pools);
+  const Node node(14);
+  for (size_t id = 0; id < num_threads; id++) {
+    for (size_t i = 0; i < bench.backlog; i++) pools[id].push(node);
+  }
+
+  struct alignas(64) Counters { size_t pushes = 0, pops = 0, steal_attempts = 0, steals = 0; };
+  std::vector<Counters> counters(num_threads);
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> ready{0};
+
+  auto worker = [&](size_t id) {
+    Pool& pool = pools[id];
+    Counters local;
+    std::minstd_rand rng(id + 1);
+    Node current(node);
+    size_t round = 0;
+
+    ready.fetch_add(1);
+    while (ready.load() < num_threads) std::this_thread::yield();
+
+    while (!stop.load(std::memory_order_relaxed)) {
+      for (size_t b = 0; b < bench.batch; b++) {
+        pool.push(current);
+        local.pushes++;
+      }
+      for (size_t b = 0; b < bench.batch; b++) {
+        if (pool.pop(current)) local.pops++;
+      }
+      if (num_threads > 1 && ++round % bench.steal_every == 0) {
+        size_t victim = (id + 1 + rng() % (num_threads - 1)) % num_threads;
+        local.steal_attempts++;
+        if (pools[victim].steal(current)) {
+          local.steals++;
+          pool.push(current);
+          local.pushes++;
+        }
+      }
+    }
+    counters[id] = local;
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < num_threads; id++) {
+    threads.emplace_back(worker, id);
+  }
+  while (ready.load() < num_threads) std::this_thread::yield();
+  auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(bench.duration));
+  stop.store(true);
+  for (auto& t : threads) {
+    t.join();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  PoolRow row{"", num_threads, seconds, 0, 0, 0, 0, 0.0};
+  for (const Counters& c : counters) {
+    row.pushes += c.pushes;
+    row.pops += c.pops;
+    row.steal_attempts += c.steal_attempts;
+    row.steals += c.steals;
+  }
+  row.mops_per_sec = (row.pushes + row.pops + row.steal_attempts) / seconds / 1e6;
+  return row;
+}
+
+int main(int argc, char** argv) {
+  // options
+  std::vector<std::string> pools = {"sequential", "locked", "chase-lev", "global"};
+  std::vector<size_t> thread_counts = {1, 2, 4};
+  PoolBench bench;
+  ReportFormat format = ReportFormat::Csv;
+  std::string output;
+
+  for (int i = 1; i < argc; i++) {
+    std::string option(argv[i]);
+    if (i + 1 == argc) {
+      std::cerr << "[ERROR] missing value for " << option << std::endl;
+      return 1;
+    }
+    std::string value(argv[++i]);
+    if (option == "--pools") pools = split(value, ',');
+    else if (option == "--threads") {
+      thread_counts.clear();
+      for (const std::string& t : split(value, ',')) thread_counts.push_back(std::max<size_t>(1, std::stoll(t)));
+    }
+    else if (option == "--duration") bench.duration = std::stod(value);
+    else if (option == "--batch") bench.batch = std::max<size_t>(1, std::stoll(value));
+    else if (option == "--backlog") bench.backlog = std::stoll(value);
+    else if (option == "--steal-every") bench.steal_every = std::max<size_t>(1, std::stoll(value));
+    else if (option == "--format") {
+      if (!parse_format(value, format)) {
+        std::cerr << "[ERROR] unknown format " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (option == "--output") output = value;
+    else {
+      std::cerr << "[ERROR] unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<PoolRow> rows;
+  for (const std::string& name : pools) {
+    PoolKind kind;
+    if (!parse_pool(name, kind)) {
+      std::cerr << "[ERROR] unknown pool " << name << std::endl;
+      return 1;
+    }
+    for (size_t threads : thread_counts) {
+      // the sequential stack cannot be shared
+      if (kind == PoolKind::Sequential && threads > 1) continue;
+      std::cerr << name << " threads=" << threads << std::endl;
+      with_pool<Node>(kind, [&](auto tag) {
+        PoolRow row = run<typename decltype(tag)::type>(bench, threads);
+        row.pool = name;
+        rows.push_back(row);
+      });
+    }
+  }
+
+  Report report({"pool", "threads", "seconds", "pushes", "pops", "steal_attempts", "steals", "mops_per_sec"});
+  for (const PoolRow& row : rows) {
+    report.row().add(row.pool).add(row.threads).add(row.seconds).add(row.pushes).add(row.pops)
+      .add(row.steal_attempts).add(row.steals).add(row.mops_per_sec);
+  }
+  if (!write_report(report, format, output)) return 1;
+
+  return 0;
+}
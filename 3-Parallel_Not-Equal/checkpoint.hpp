@@ -0,0 +1,94 @@
+#ifndef PARALLEL_NOT_EQUAL_CHECKPOINT_HPP
+#define PARALLEL_NOT_EQUAL_CHECKPOINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+// Binary checkpoint of a tree search: the open nodes of the pool and the running counters.
+//
+// File layout (little-endian, as written by the machine):
+//   CheckpointHeader
+//   num_records records of record_size bytes (the encoded nodes)
+// The checksum is the FNV-1a hash of the header fields before it, then of the records, so
+// that corrupted counters are detected as well as corrupted nodes. A checkpoint is first written to
+// `<file>.tmp` and then renamed, so a crash while writing never destroys the previous one.
+
+constexpr char CHECKPOINT_MAGIC[4] = {'T', 'S', 'C', 'K'};
+constexpr uint32_t CHECKPOINT_VERSION = 2; // 2: the checksum covers the header
+
+struct CheckpointHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t problem_size;   // size of the problem instance (e.g., number of queens)
+    uint32_t flags;          // search options that change the meaning of the counters
+    uint64_t record_size;    // size in bytes of one encoded node
+    uint64_t num_records;    // number of open nodes
+    uint64_t exploredTree;   // counters of the nodes already explored
+    uint64_t exploredSol;
+    uint64_t checksum;       // FNV-1a hash of the fields above and of the records (last field)
+};
+
+inline uint64_t fnv1a(const uint8_t* data, size_t size, uint64_t hash = 14695981039346656037ull){
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// checksum of a checkpoint: every field of the header but the checksum, then the records
+inline uint64_t checkpoint_checksum(const CheckpointHeader& header, const std::vector<uint8_t>& records){
+    const uint64_t hash = fnv1a(reinterpret_cast<const uint8_t*>(&header), offsetof(CheckpointHeader, checksum));
+    return fnv1a(records.data(), records.size(), hash);
+}
+
+// write the header and the encoded nodes to `filename`, atomically replacing the previous
+// checkpoint. The magic, version, number of records and checksum are filled in here.
+inline bool write_checkpoint(const std::string& filename, CheckpointHeader header, const std::vector<uint8_t>& records){
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.num_records = header.record_size == 0 ? 0 : records.size() / header.record_size;
+    header.checksum = checkpoint_checksum(header, records);
+
+    std::string tmp = filename + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (f == nullptr) {
+        std::cerr << "[ERROR] Couldn't open " << tmp << "\n";
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    if (!records.empty()) ok = ok && std::fwrite(records.data(), records.size(), 1, f) == 1;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::cerr << "[ERROR] Couldn't write " << filename << "\n";
+        return false;
+    }
+    return true;
+}
+
+// read a checkpoint written by `write_checkpoint`, checking its magic, version and checksum
+inline bool read_checkpoint(const std::string& filename, CheckpointHeader& header, std::vector<uint8_t>& records){
+    FILE* f = std::fopen(filename.c_str(), "rb");
+    if (f == nullptr) {
+        std::cerr << "[ERROR] Couldn't open " << filename << "\n";
+        return false;
+    }
+    bool ok = std::fread(&header, sizeof(header), 1, f) == 1
+        && std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0
+        && header.version == CHECKPOINT_VERSION;
+    if (ok) {
+        records.resize(header.num_records * header.record_size);
+        if (!records.empty()) ok = std::fread(records.data(), records.size(), 1, f) == 1;
+        ok = ok && checkpoint_checksum(header, records) == header.checksum;
+    }
+    std::fclose(f);
+    if (!ok) std::cerr << "[ERROR] " << filename << " is not a valid checkpoint\n";
+    return ok;
+}
+
+#endif
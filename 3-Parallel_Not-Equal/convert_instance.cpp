@@ -0,0 +1,46 @@
+/*
+ * Description:
+ * Converter between the text format of the PCO instances (N/U/C sections, as written by
+ * generate_instances.py) and the binary format of parser.hpp (a header, u, and C as a
+ * packed bitset, versioned and checksummed). The input format is detected from the file;
+ * the output is binary, or text with `--text`.
+ *
+ * usage: convert_instance INPUT OUTPUT [--text]
+ */
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <sys/stat.h>
+
+#include "parser.hpp"
+
+// size of a file in bytes (0 if it cannot be read)
+size_t file_size(const std::string& filename)
+{
+  struct stat info;
+  return ::stat(filename.c_str(), &info) == 0 ? info.st_size : 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 4 || (argc == 4 && std::string(argv[3]) != "--text")) {
+    std::cout << "usage: " << argv[0] << " INPUT OUTPUT [--text]" << std::endl;
+    return 1;
+  }
+  const std::string input(argv[1]);
+  const std::string output(argv[2]);
+  const bool text = argc == 4;
+
+  Data data;
+  if (!data.read_input(input)) return 1;
+  std::cout << "Read " << input << ": n = " << data.get_n() << ", " << data.get_bytes_read() << " bytes in "
+            << 1000.0 * data.get_read_seconds() << " ms (" << data.get_read_mb_per_s() << " MB/s)" << std::endl;
+
+  auto start = std::chrono::steady_clock::now();
+  if (!(text ? data.write_text(output) : data.write_binary(output))) return 1;
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Wrote " << output << " (" << (text ? "text" : "binary") << "): " << file_size(output)
+            << " bytes in " << ms << " ms" << std::endl;
+
+  return 0;
+}
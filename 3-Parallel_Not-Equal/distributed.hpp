@@ -0,0 +1,328 @@
+#ifndef PARALLEL_NOT_EQUAL_DISTRIBUTED_HPP
+#define PARALLEL_NOT_EQUAL_DISTRIBUTED_HPP
+
+// Distributed N-Queens search over several processes of a Linux host, talking over a Unix
+// domain socket: a coordinator hands out frontier subtrees to worker processes and
+// collects their counters. When the coordinator runs out of subtrees while some workers
+// are idle, it asks the busy workers to split their work: they send back the shallowest
+// half of their DFS stack, which is then handed to the idle workers.
+
+#include <cerrno>
+#include <deque>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "nqueens.hpp"
+
+// configuration of the distributed search
+struct DistributedConfig {
+  size_t num_procs = 2;   // number of worker processes
+  std::string socket;     // path of the Unix domain socket
+  bool spawn = true;      // fork the worker processes (otherwise, wait for them to connect)
+  size_t max_batch = 64;  // maximum number of frontier nodes sent at once
+};
+
+// messages between the coordinator (C) and the workers (W)
+enum MessageType : uint32_t {
+  MSG_HELLO,   // C -> W: problem size in `a`, kernel in `b`
+  MSG_REQUEST, // W -> C: the worker is idle; counters of the work done since the last request in `a`, `b`
+  MSG_WORK,    // C -> W: `count` nodes to explore
+  MSG_SPLIT,   // C -> W: send back part of the open nodes
+  MSG_DONATE,  // W -> C: `count` open nodes given back
+  MSG_STOP     // C -> W: the search is over
+};
+
+struct MessageHeader {
+  uint32_t type;
+  uint32_t count; // number of encoded nodes following the header
+  uint64_t a;
+  uint64_t b;
+};
+
+inline bool send_all(int fd, const void* data, size_t size)
+{
+  const char* p = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+inline bool recv_all(int fd, void* data, size_t size)
+{
+  char* p = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t n = ::recv(fd, p, size, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+// send a message with the nodes in `nodes`
+template <typename Nodes>
+bool send_message(int fd, MessageType type, uint64_t a, uint64_t b, const Nodes& nodes)
+{
+  std::vector<uint8_t> records;
+  for (const Node& node : nodes) encode_node(node, records);
+  MessageHeader header{type, uint32_t(nodes.size()), a, b};
+  return send_all(fd, &header, sizeof(header)) && send_all(fd, records.data(), records.size());
+}
+
+inline bool send_message(int fd, MessageType type, uint64_t a = 0, uint64_t b = 0)
+{
+  return send_message(fd, type, a, b, std::vector<Node>());
+}
+
+// receive a message, appending its nodes to `nodes`
+template <typename Nodes>
+bool recv_message(int fd, MessageHeader& header, Nodes& nodes, size_t N)
+{
+  if (!recv_all(fd, &header, sizeof(header))) return false;
+  std::vector<uint8_t> records(header.count * encoded_size(N));
+  if (!recv_all(fd, records.data(), records.size())) return false;
+  for (size_t i = 0; i < header.count; i++) {
+    nodes.push_back(decode_node(&records[i * encoded_size(N)], N));
+  }
+  return true;
+}
+
+inline sockaddr_un socket_address(const std::string& path)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("socket path too long: " + path);
+  std::strcpy(addr.sun_path, path.c_str());
+  return addr;
+}
+
+// DFS stack of a worker process, which can give away its shallowest nodes
+struct DonorStack {
+  SlabDeque<Node> nodes;
+
+  void push(const Node& node) {
+    nodes.push_back(node);
+  }
+};
+
+// search loop of a worker process connected to the coordinator through `fd`: explore the
+// subtrees it sends until it says stop. Returns false if the connection is lost.
+template <typename Kernel>
+bool worker_loop(int fd, size_t N)
+{
+  const NQueens<Kernel> problem(N);
+  MessageHeader header;
+  std::vector<Node> received;
+  DonorStack pool;
+  size_t tree_loc = 0;
+  size_t num_sol = 0;
+
+  // reply to a split request with the shallowest half of the stack
+  auto donate = [&]() {
+    std::vector<Node> donated;
+    for (size_t k = pool.nodes.size() / 2; k > 0; k--) {
+      donated.push_back(pool.nodes.front());
+      pool.nodes.pop_front();
+    }
+    return send_message(fd, MSG_DONATE, 0, 0, donated);
+  };
+
+  while (true) {
+    // report the work done and wait for more
+    if (!send_message(fd, MSG_REQUEST, tree_loc, num_sol)) return false;
+    tree_loc = 0;
+    num_sol = 0;
+
+    received.clear();
+    do {
+      if (!recv_message(fd, header, received, N)) return false;
+      if (header.type == MSG_SPLIT && !donate()) return false;
+    } while (header.type == MSG_SPLIT);
+    if (header.type == MSG_STOP) return true;
+
+    for (const Node& node : received) pool.push(node);
+
+    // depth-first search, checking for split requests every few thousand nodes
+    size_t steps = 0;
+    while (!pool.nodes.empty()) {
+      Node currentNode = pool.nodes.back();
+      pool.nodes.pop_back();
+      evaluate_and_branch(problem, currentNode, pool, tree_loc, num_sol);
+
+      if (++steps % 4096 == 0) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 0) > 0) {
+          std::vector<Node> none;
+          if (!recv_message(fd, header, none, N)) return false;
+          if (header.type == MSG_SPLIT && !donate()) return false;
+        }
+      }
+    }
+  }
+}
+
+// worker process: connect to the coordinator at `socket_path` and run the search loop with
+// the problem size and kernel it announces. Returns false if the connection is lost.
+inline bool distributed_worker(const std::string& socket_path)
+{
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr = socket_address(socket_path);
+  if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    std::cerr << "[ERROR] Couldn't connect to " << socket_path << "\n";
+    return false;
+  }
+
+  MessageHeader header;
+  std::vector<Node> none;
+  if (!recv_message(fd, header, none, 0) || header.type != MSG_HELLO) return false;
+
+  bool ok = false;
+  with_kernel(KernelKind(header.b), header.a, [&](auto kernel) {
+    ok = worker_loop<decltype(kernel)>(fd, header.a);
+  });
+
+  ::close(fd);
+  return ok;
+}
+
+// coordinator: expand `roots` down to depth `cutoff`, then distribute the frontier nodes to
+// the worker processes and sum their counters into `exploredTree` and `exploredSol`.
+// The workers use the (resolved) `kernel`.
+inline void distributed_dfs(const std::vector<Node>& roots, size_t N, size_t cutoff, KernelKind kernel,
+                            const DistributedConfig& config, size_t& exploredTree, size_t& exploredSol)
+{
+  std::vector<Node> frontier = generate_frontier(NQueens<>(N), roots, cutoff, exploredTree, exploredSol);
+  std::deque<Node> queue(frontier.begin(), frontier.end());
+
+  // listen on the socket and start the workers
+  int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr = socket_address(config.socket);
+  ::unlink(config.socket.c_str());
+  if (listen_fd < 0 || ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+      || ::listen(listen_fd, config.num_procs) != 0) {
+    throw std::runtime_error("cannot listen on " + config.socket);
+  }
+
+  std::vector<pid_t> children;
+  if (config.spawn) {
+    std::cout.flush();
+    for (size_t p = 0; p < config.num_procs; p++) {
+      pid_t pid = ::fork();
+      if (pid == 0) {
+        ::close(listen_fd);
+        ::_exit(distributed_worker(config.socket) ? 0 : 1);
+      }
+      if (pid < 0) throw std::runtime_error("cannot fork the worker processes");
+      children.push_back(pid);
+    }
+  }
+
+  // state of each worker, as seen by the coordinator
+  struct Peer {
+    int fd;
+    bool idle = false;          // waiting for work
+    bool split_pending = false; // a split request was sent and not answered yet
+    std::chrono::steady_clock::time_point next_split{}; // no split request before this time
+  };
+  // delay before asking again a worker that had nothing to give
+  const auto split_retry = std::chrono::milliseconds(10);
+  std::vector<Peer> peers;
+  for (size_t p = 0; p < config.num_procs; p++) {
+    int fd = ::accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) throw std::runtime_error("cannot accept the worker processes");
+    send_message(fd, MSG_HELLO, N, uint64_t(kernel));
+    peers.push_back(Peer{fd});
+  }
+  ::close(listen_fd);
+  ::unlink(config.socket.c_str());
+
+  std::vector<pollfd> pfds(peers.size());
+  while (true) {
+    // hand out work to the idle workers, in batches shrinking with the remaining work
+    for (Peer& peer : peers) {
+      if (!peer.idle || queue.empty()) continue;
+      size_t batch = std::min(config.max_batch, std::max<size_t>(1, queue.size() / (2 * peers.size())));
+      std::vector<Node> nodes(queue.begin(), queue.begin() + batch);
+      queue.erase(queue.begin(), queue.begin() + batch);
+      send_message(peer.fd, MSG_WORK, 0, 0, nodes);
+      peer.idle = false;
+    }
+
+    // no work left here: ask the busy workers to split theirs, or stop if all are idle
+    bool any_idle = false, all_idle = true, any_pending = false;
+    for (const Peer& peer : peers) {
+      any_idle |= peer.idle;
+      all_idle &= peer.idle;
+      any_pending |= peer.split_pending;
+    }
+    if (all_idle && !any_pending) break;
+    int timeout_ms = -1;
+    if (any_idle && queue.empty()) {
+      auto now = std::chrono::steady_clock::now();
+      for (Peer& peer : peers) {
+        if (peer.idle || peer.split_pending) continue;
+        if (now < peer.next_split) {
+          timeout_ms = split_retry.count();
+          continue;
+        }
+        send_message(peer.fd, MSG_SPLIT);
+        peer.split_pending = true;
+      }
+    }
+
+    for (size_t p = 0; p < peers.size(); p++) {
+      pfds[p] = pollfd{peers[p].fd, POLLIN, 0};
+    }
+    if (::poll(pfds.data(), pfds.size(), timeout_ms) < 0 && errno != EINTR) {
+      throw std::runtime_error("poll failed");
+    }
+
+    for (size_t p = 0; p < peers.size(); p++) {
+      if (!(pfds[p].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+      MessageHeader header;
+      if (!recv_message(peers[p].fd, header, queue, N)) {
+        throw std::runtime_error("worker process " + std::to_string(p) + " disconnected");
+      }
+      if (header.type == MSG_REQUEST) {
+        exploredTree += header.a;
+        exploredSol += header.b;
+        peers[p].idle = true;
+      }
+      else if (header.type == MSG_DONATE) {
+        peers[p].split_pending = false;
+        if (header.count == 0) peers[p].next_split = std::chrono::steady_clock::now() + split_retry;
+      }
+    }
+  }
+
+  for (Peer& peer : peers) {
+    send_message(peer.fd, MSG_STOP);
+    ::close(peer.fd);
+  }
+  for (pid_t pid : children) {
+    ::waitpid(pid, nullptr, 0);
+  }
+}
+
+// solve the N-Queens problem as configured by `config` (frontier depth, symmetry breaking,
+// resume) with the distributed search
+inline SearchResult distributed_solve(const SearchConfig& config, const DistributedConfig& distributed)
+{
+  SearchResult result;
+  std::vector<Node> roots = initial_roots(config, result);
+  result.kernel = resolve_kernel(config.kernel, config.N);
+  distributed_dfs(roots, config.N, config.cutoff, result.kernel, distributed, result.exploredTree, result.exploredSol);
+  rescale(result, config.N);
+  return result;
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Description:
+ * Generator of random PCO instances (see generator.hpp), a parallel and scalable version
+ * of generate_instances.py: it writes the instance in the binary format of parser.hpp, or
+ * in the text format with `--text`, as it is generated. The instance depends only on its
+ * parameters and on the seed, not on the number of threads.
+ *
+ * usage: generate_instance N OUTPUT [--density 0.5] [--degrees uniform|power-law] [--exponent 2.5]
+ *                          [--max-value 100] [--seed 0] [--threads K] [--text]
+ */
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <algorithm>
+
+#include "generator.hpp"
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cout << "usage: " << argv[0] << " N OUTPUT [--density 0.5] [--degrees uniform|power-law] [--exponent 2.5]"
+              << " [--max-value 100] [--seed 0] [--threads K] [--text]" << std::endl;
+    return 1;
+  }
+  GeneratorConfig config;
+  config.n = std::stoll(argv[1]);
+  const std::string output(argv[2]);
+
+  for (int i = 3; i < argc; i++) {
+    std::string option(argv[i]);
+    if (option == "--text") {
+      config.text = true;
+      continue;
+    }
+    if (i + 1 == argc) {
+      std::cout << "[ERROR] missing value for " << option << std::endl;
+      return 1;
+    }
+    std::string value(argv[++i]);
+    if (option == "--density") config.density = std::stod(value);
+    else if (option == "--exponent") config.exponent = std::stod(value);
+    else if (option == "--max-value") config.max_value = std::stoi(value);
+    else if (option == "--seed") config.seed = std::stoull(value);
+    else if (option == "--threads") {
+      config.num_threads = std::stoll(value);
+      if (config.num_threads == 0) config.num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    else if (option == "--degrees") {
+      if (!parse_degrees(value, config.degrees)) {
+        std::cout << "[ERROR] unknown degree distribution " << value << std::endl;
+        return 1;
+      }
+    }
+    else {
+      std::cout << "[ERROR] unknown option " << option << std::endl;
+      return 1;
+    }
+  }
+
+  GeneratorResult result;
+  try {
+    result = generate_instance(config, output);
+  }
+  catch (const std::exception& e) {
+    std::cout << "[ERROR] " << e.what() << std::endl;
+    return 1;
+  }
+
+  const double possible = config.n > 1 ? double(config.n) * (config.n - 1) : 1.0;
+  std::cout << "Wrote " << output << " (" << (config.text ? "text" : "binary") << "): n = " << config.n << ", "
+            << result.pairs << " pairs (density " << result.pairs / possible << ", " << degrees_name(config.degrees)
+            << " degrees), seed " << config.seed << std::endl;
+  std::cout << result.bytes << " bytes in " << 1000.0 * result.seconds << " ms with " << config.num_threads
+            << " threads (" << result.bytes / std::max(result.seconds, 1e-9) / 1e6 << " MB/s)" << std::endl;
+
+  return 0;
+}
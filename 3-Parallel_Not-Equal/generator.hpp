@@ -0,0 +1,283 @@
+#ifndef PARALLEL_NOT_EQUAL_GENERATOR_HPP
+#define PARALLEL_NOT_EQUAL_GENERATOR_HPP
+
+// Generator of random not-equal instances, in the text or the binary format of parser.hpp.
+//
+// The rows of C are generated in the layout of `Data` (bitsets of (n + 63) / 64 words) by
+// batches, in parallel, and each batch is written before the next one is generated: the
+// memory used is that of a batch, whatever the size of the instance. In the text format,
+// the rows are also formatted in parallel.
+//
+// The numbers are drawn by SplitMix64, with an independent stream per row of C (and one
+// for u, one for the degrees): an instance depends only on its parameters and its seed,
+// not on the number of threads nor on the size of the batches.
+//
+// The degrees of the variables follow one of two distributions, for the same expected
+// number of pairs (density * n * (n - 1)):
+// - uniform: each pair (i,j) is in C with probability `density` (binomial degrees, as
+//   generate_instances.py);
+// - power law: each variable k gets a weight w_k = (r_k + 1)^(-1 / (exponent - 1)), for a
+//   random rank r_k, and (i,j) is in C with probability min(1, c * w_i * w_j) (Chung & Lu,
+//   2002), so that a few variables have most of the pairs. The probabilities capped at 1
+//   make the density a bit lower than asked on dense instances.
+// The pairs (i,i) are never drawn.
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+#include "parser.hpp"
+
+// SplitMix64 (Steele, Lea & Flood, 2014): next random word of the stream of `state`
+inline uint64_t splitmix64(uint64_t& state)
+{
+  uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// initial state of the stream `k` of the seed `seed`
+inline uint64_t splitmix_stream(uint64_t seed, uint64_t k)
+{
+  uint64_t state = seed + k * 0xD1B54A32D192ED03ull;
+  return splitmix64(state);
+}
+
+// uniform double in [0, 1), from the 53 upper bits of a random word
+inline double splitmix_unit(uint64_t& state)
+{
+  return (splitmix64(state) >> 11) * 0x1.0p-53;
+}
+
+// distribution of the degrees of the variables
+enum class DegreeDistribution {
+  Uniform, // every pair with the same probability
+  PowerLaw // Chung-Lu weights following a power law
+};
+
+inline const char* degrees_name(DegreeDistribution degrees)
+{
+  return degrees == DegreeDistribution::PowerLaw ? "power-law" : "uniform";
+}
+
+inline bool parse_degrees(const std::string& name, DegreeDistribution& degrees)
+{
+  if (name == "uniform") degrees = DegreeDistribution::Uniform;
+  else if (name == "power-law") degrees = DegreeDistribution::PowerLaw;
+  else return false;
+  return true;
+}
+
+// parameters of an instance, and how to generate it
+struct GeneratorConfig {
+  size_t n = 0;                          // number of variables
+  double density = 0.5;                  // expected fraction of the pairs (i,j), i != j, in C
+  DegreeDistribution degrees = DegreeDistribution::Uniform;
+  double exponent = 2.5;                 // power law: P(degree = d) ~ d^-exponent (> 2)
+  int max_value = 100;                   // u_i uniform in [0, max_value]
+  uint64_t seed = 0;
+  bool text = false;                     // text format instead of binary
+  size_t num_threads = 1;
+  size_t batch_bytes = size_t(64) << 20; // output generated between two writes
+};
+
+// outcome of a generation
+struct GeneratorResult {
+  size_t pairs = 0;     // pairs in C
+  size_t bytes = 0;     // size of the file written
+  double seconds = 0.0; // time taken
+};
+
+// random instance of a configuration, generated row by row
+struct InstanceGenerator {
+  GeneratorConfig config;
+  size_t words_per_row;
+  std::vector<int> u;
+  std::vector<double> weight; // power law: weight of each variable, times sqrt(c)
+
+  explicit InstanceGenerator(const GeneratorConfig& config)
+      : config(config), words_per_row((config.n + 63) / 64), u(config.n) {
+    if (config.density < 0.0 || config.density > 1.0) throw std::invalid_argument("the density must be in [0, 1]");
+    if (config.max_value < 0) throw std::invalid_argument("the largest value must be non-negative");
+    const size_t n = config.n;
+    uint64_t state = splitmix_stream(config.seed, 0);
+    for (size_t i = 0; i < n; i++) u[i] = splitmix64(state) % (uint64_t(config.max_value) + 1);
+
+    if (config.degrees == DegreeDistribution::PowerLaw && n > 1) {
+      if (config.exponent <= 2.0) throw std::invalid_argument("the exponent of the power law must be above 2");
+      // random ranks: Fisher-Yates shuffle of 0..n-1
+      std::vector<uint32_t> rank(n);
+      for (size_t k = 0; k < n; k++) rank[k] = k;
+      state = splitmix_stream(config.seed, 1);
+      for (size_t k = n - 1; k > 0; k--) std::swap(rank[k], rank[splitmix64(state) % (k + 1)]);
+      weight.resize(n);
+      double sum = 0.0;
+      double squares = 0.0;
+      for (size_t k = 0; k < n; k++) {
+        weight[k] = std::pow(rank[k] + 1.0, -1.0 / (config.exponent - 1.0));
+        sum += weight[k];
+        squares += weight[k] * weight[k];
+      }
+      // c * (sum_i sum_{j != i} w_i * w_j) = density * n * (n - 1)
+      const double c = config.density * n * (n - 1) / (sum * sum - squares);
+      for (double& w : weight) w *= std::sqrt(c);
+    }
+  }
+
+  // row i of C, in the layout of `Data`; returns its number of pairs. Each word is built
+  // from 64 draws without branches, whose outcome would be unpredictable.
+  size_t row(size_t i, uint64_t* words) const {
+    uint64_t state = splitmix_stream(config.seed, 2 + i);
+    const size_t n = config.n;
+    // uniform: (i,j) is in C if the draw is below density * 2^64
+    const bool all = config.density >= 1.0;
+    const uint64_t threshold = all ? 0 : uint64_t(std::ldexp(config.density, 64));
+    const double wi = weight.empty() ? 0.0 : weight[i];
+    size_t pairs = 0;
+    for (size_t w = 0; w < words_per_row; w++) {
+      const size_t count = std::min<size_t>(64, n - 64 * w);
+      uint64_t bits = 0;
+      if (weight.empty()) {
+        for (size_t b = 0; b < count; b++) bits |= uint64_t(all || splitmix64(state) < threshold) << b;
+      }
+      else {
+        for (size_t b = 0; b < count; b++) bits |= uint64_t(splitmix_unit(state) < wi * weight[64 * w + b]) << b;
+      }
+      if (w == i / 64) bits &= ~(uint64_t(1) << (i % 64));
+      words[w] = bits;
+      pairs += __builtin_popcountll(bits);
+    }
+    return pairs;
+  }
+};
+
+// run `f(k)` for k in [first, last) with `num_threads` threads
+template <typename F>
+void generator_parallel_for(size_t first, size_t last, size_t num_threads, F f)
+{
+  std::atomic<size_t> next(first);
+  auto worker = [&]() {
+    for (size_t k; (k = next.fetch_add(1)) < last;) f(k);
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < std::min(num_threads, last - first); t++) workers.emplace_back(worker);
+  worker();
+  for (std::thread& t : workers) t.join();
+}
+
+// text of row i of C, as its lines "i,j;0|1", given the decimal representations of
+// 0..n-1 followed by ';'
+inline void format_row(size_t i, const uint64_t* words, const std::vector<std::string>& columns,
+                       size_t columns_length, std::vector<char>& text)
+{
+  const std::string prefix = std::to_string(i) + ",";
+  text.resize(columns.size() * (prefix.size() + 2) + columns_length);
+  char* p = text.data();
+  for (size_t j = 0; j < columns.size(); j++) {
+    std::memcpy(p, prefix.data(), prefix.size());
+    p += prefix.size();
+    std::memcpy(p, columns[j].data(), columns[j].size());
+    p += columns[j].size();
+    *p++ = (words[j / 64] >> (j % 64)) & 1 ? '1' : '0';
+    *p++ = '\n';
+  }
+}
+
+// generate the instance of `config` into `filename`; throws std::runtime_error if the file
+// cannot be written
+inline GeneratorResult generate_instance(const GeneratorConfig& config, const std::string& filename)
+{
+  auto start = std::chrono::steady_clock::now();
+  const InstanceGenerator generator(config);
+  const size_t n = config.n;
+  const size_t words = generator.words_per_row;
+  GeneratorResult result;
+
+  FILE* f = std::fopen(filename.c_str(), "wb");
+  if (f == nullptr) throw std::runtime_error("cannot open " + filename);
+  bool ok = true;
+  auto write = [&](const void* data, size_t size) {
+    ok = ok && (size == 0 || std::fwrite(data, size, 1, f) == 1);
+    result.bytes += size;
+  };
+
+  // N and U
+  InstanceHeader header;
+  std::vector<std::string> columns; // text: "j;" for each j
+  size_t columns_length = 0;
+  if (config.text) {
+    std::string head = "N\n" + std::to_string(n) + "\nU\n";
+    for (size_t i = 0; i < n; i++) head += std::to_string(i) + ";" + std::to_string(generator.u[i]) + "\n";
+    head += "C\n";
+    write(head.data(), head.size());
+    columns.resize(n);
+    for (size_t j = 0; j < n; j++) {
+      columns[j] = std::to_string(j) + ";";
+      columns_length += columns[j].size();
+    }
+  }
+  else {
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, INSTANCE_MAGIC, sizeof(header.magic));
+    header.version = INSTANCE_VERSION;
+    header.n = n;
+    header.words_per_row = words;
+    header.u_offset = sizeof(header);
+    header.C_offset = (header.u_offset + n * sizeof(int32_t) + 63) / 64 * 64;
+    // u and the padding up to C, a multiple of 8 bytes, so the checksum can be continued over C
+    std::vector<char> body(header.C_offset - sizeof(header), 0);
+    for (size_t i = 0; i < n; i++) {
+      int32_t value = generator.u[i];
+      std::memcpy(&body[i * sizeof(value)], &value, sizeof(value));
+    }
+    header.checksum = fnv1a_words(body.data(), body.size());
+    write(&header, sizeof(header));
+    write(body.data(), body.size());
+  }
+
+  // C, by batches of rows
+  const size_t row_bytes = config.text ? n * (std::to_string(n).size() + 3) + columns_length
+                                       : words * sizeof(uint64_t);
+  const size_t batch = std::max<size_t>(std::max<size_t>(config.num_threads, 1), config.batch_bytes / std::max<size_t>(row_bytes, 1));
+  std::vector<uint64_t> rows(std::min(batch, n) * words);
+  std::vector<size_t> pairs(std::min(batch, n));
+  std::vector<std::vector<char>> texts(config.text ? std::min(batch, n) : 0);
+  for (size_t first = 0; first < n && ok; first += batch) {
+    const size_t last = std::min(first + batch, n);
+    generator_parallel_for(first, last, config.num_threads, [&](size_t i) {
+      uint64_t* words_i = &rows[(i - first) * words];
+      pairs[i - first] = generator.row(i, words_i);
+      if (config.text) format_row(i, words_i, columns, columns_length, texts[i - first]);
+    });
+    for (size_t i = first; i < last; i++) result.pairs += pairs[i - first];
+    if (config.text) {
+      for (size_t i = first; i < last; i++) write(texts[i - first].data(), texts[i - first].size());
+    }
+    else {
+      const char* data = reinterpret_cast<const char*>(rows.data());
+      const size_t size = (last - first) * words * sizeof(uint64_t);
+      header.checksum = fnv1a_words(data, size, header.checksum);
+      write(data, size);
+    }
+  }
+
+  // the checksum of the binary format is known once C is written
+  if (!config.text && ok) {
+    ok = std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, f) == 1;
+  }
+  ok = (std::fclose(f) == 0) && ok;
+  if (!ok) throw std::runtime_error("cannot write " + filename);
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef PARALLEL_NOT_EQUAL_GRAPH_HPP
+#define PARALLEL_NOT_EQUAL_GRAPH_HPP
+
+// Preprocessing of a not-equal instance before the search: its conflict graph, where i and
+// j are adjacent if (i,j) or (j,i) is in C, the connected components of the graph, and
+// the order in which the variables of a component are branched on.
+//
+// The components share no constraint: they are solved one after the other, and the
+// number of solutions of the instance is the product of theirs. A component with no
+// solution makes the instance infeasible, whatever the others.
+//
+// The orders put the most constrained variables first, so that the search fails as high
+// in the tree as possible: by decreasing degree, or by degeneracy (the reverse of the
+// smallest-last order: the variables of the densest core of the graph come first, and
+// every later variable has few neighbors after it).
+//
+// Around a few variables, e.g. those changed by a delta, `local_conflict_graph` lists only
+// their neighbors.
+//
+// The pairs (i,i) of C are dropped: x_i != x_i cannot hold, and the generated instances
+// have such pairs by chance rather than to make the instance infeasible.
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+
+#include "parser.hpp"
+
+// conflict graph of an instance, as symmetric CSR adjacency lists
+struct ConflictGraph {
+  size_t n = 0;                  // number of variables
+  std::vector<size_t> offsets;   // neighbors of i: targets[offsets[i]] to targets[offsets[i + 1] - 1]
+  std::vector<uint32_t> targets; // in increasing order
+  size_t self_loops = 0;         // pairs (i,i) of C dropped
+
+  inline Neighbors neighbors(size_t i) const {return {targets.data() + offsets[i], targets.data() + offsets[i + 1]};}
+  inline size_t degree(size_t i) const {return offsets[i + 1] - offsets[i];}
+  inline size_t num_edges() const {return targets.size() / 2;}
+};
+
+// conflict graph of `data`, merging the pairs (i,j) and (j,i) of C
+inline ConflictGraph build_conflict_graph(Data& data)
+{
+  if (!data.has_adjacency()) data.build_adjacency();
+  ConflictGraph graph;
+  graph.n = data.get_n();
+  graph.offsets.assign(graph.n + 1, 0);
+  graph.targets.reserve(2 * data.get_num_pairs());
+  for (size_t i = 0; i < graph.n; i++) {
+    // union of the sorted out- and in-neighbors of i
+    Neighbors out = data.get_out_neighbors(i);
+    Neighbors in = data.get_in_neighbors(i);
+    const uint32_t* a = out.begin();
+    const uint32_t* b = in.begin();
+    while (a != out.end() || b != in.end()) {
+      uint32_t k;
+      if (b == in.end() || (a != out.end() && *a < *b)) k = *a++;
+      else if (a == out.end() || *b < *a) k = *b++;
+      else { k = *a++; b++; }
+      if (k == i) graph.self_loops++;
+      else graph.targets.push_back(k);
+    }
+    graph.offsets[i + 1] = graph.targets.size();
+  }
+  return graph;
+}
+
+// conflict graph of `data` around `variables`: only their neighbors are listed (the other
+// variables have none), found from the bitset of C in O(n) per variable, so that a small
+// part of a large instance is visited without building its CSR lists
+inline ConflictGraph local_conflict_graph(Data& data, const std::vector<uint32_t>& variables)
+{
+  ConflictGraph graph;
+  graph.n = data.get_n();
+  graph.offsets.assign(graph.n + 1, 0);
+  std::vector<bool> listed(graph.n, false);
+  for (uint32_t i : variables) listed[i] = true;
+  for (size_t i = 0; i < graph.n; i++) {
+    if (listed[i]) {
+      const uint64_t* row = data.get_C_row(i);
+      for (size_t j = 0; j < graph.n; j++) {
+        if (((row[j / 64] >> (j % 64)) & 1) || data.get_C_at(j, i)) {
+          if (j == i) graph.self_loops++;
+          else graph.targets.push_back(j);
+        }
+      }
+    }
+    graph.offsets[i + 1] = graph.targets.size();
+  }
+  return graph;
+}
+
+// connected components of `graph`, each as its variables in increasing order; the
+// components are sorted by their smallest variable
+inline std::vector<std::vector<uint32_t>> connected_components(const ConflictGraph& graph)
+{
+  std::vector<std::vector<uint32_t>> components;
+  std::vector<bool> seen(graph.n, false);
+  std::vector<uint32_t> stack;
+  for (size_t root = 0; root < graph.n; root++) {
+    if (seen[root]) continue;
+    std::vector<uint32_t> component;
+    seen[root] = true;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      uint32_t i = stack.back();
+      stack.pop_back();
+      component.push_back(i);
+      for (uint32_t k : graph.neighbors(i)) {
+        if (!seen[k]) {
+          seen[k] = true;
+          stack.push_back(k);
+        }
+      }
+    }
+    std::sort(component.begin(), component.end());
+    components.push_back(std::move(component));
+  }
+  return components;
+}
+
+// order in which the variables are branched on
+enum class VariableOrder {
+  Index,     // increasing index
+  Degree,    // decreasing degree
+  Degeneracy // reverse of the smallest-last order
+};
+
+inline const char* order_name(VariableOrder order)
+{
+  switch (order) {
+    case VariableOrder::Index: return "index";
+    case VariableOrder::Degree: return "degree";
+    default: return "degeneracy";
+  }
+}
+
+inline bool parse_order(const std::string& name, VariableOrder& order)
+{
+  if (name == "index") order = VariableOrder::Index;
+  else if (name == "degree") order = VariableOrder::Degree;
+  else if (name == "degeneracy") order = VariableOrder::Degeneracy;
+  else return false;
+  return true;
+}
+
+// the variables of a component in the branching order `order`. Ties are broken by index.
+inline std::vector<uint32_t> order_variables(const ConflictGraph& graph, const std::vector<uint32_t>& component,
+                                             VariableOrder order)
+{
+  std::vector<uint32_t> ordered(component);
+  if (order == VariableOrder::Degree) {
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [&](uint32_t a, uint32_t b) { return graph.degree(a) > graph.degree(b); });
+  }
+  else if (order == VariableOrder::Degeneracy) {
+    // smallest-last: remove a variable of smallest remaining degree until none is left,
+    // with the variables bucketed by remaining degree (Matula & Beck, 1983)
+    const size_t m = component.size();
+    size_t max_degree = 0;
+    for (uint32_t i : component) max_degree = std::max(max_degree, graph.degree(i));
+    std::vector<std::vector<uint32_t>> buckets(max_degree + 1);
+    std::vector<size_t> remaining(graph.n, 0);
+    std::vector<bool> removed(graph.n, false);
+    // filled in reverse, so that the bucket of a degree pops its variables by increasing index
+    for (size_t r = m; r-- > 0;) {
+      uint32_t i = component[r];
+      remaining[i] = graph.degree(i);
+      buckets[remaining[i]].push_back(i);
+    }
+    ordered.clear();
+    size_t d = 0;
+    while (ordered.size() < m) {
+      d = d > 0 ? d - 1 : 0; // a removal lowers the smallest degree by one at most
+      while (buckets[d].empty()) d++;
+      uint32_t i = buckets[d].back();
+      buckets[d].pop_back();
+      // stale entry of a variable removed or moved to a lower bucket
+      if (removed[i] || remaining[i] != d) continue;
+      removed[i] = true;
+      ordered.push_back(i);
+      for (uint32_t k : graph.neighbors(i)) {
+        if (!removed[k]) buckets[--remaining[k]].push_back(k);
+      }
+    }
+    std::reverse(ordered.begin(), ordered.end());
+  }
+  return ordered;
+}
+
+// outcome of the preprocessing of an instance
+struct Preprocessing {
+  ConflictGraph graph;
+  std::vector<std::vector<uint32_t>> components; // variables of each component, in branching order
+  double seconds = 0.0;                          // time taken
+};
+
+// preprocess `data`: conflict graph, components, and the order of their variables
+inline Preprocessing preprocess(Data& data, VariableOrder order)
+{
+  auto start = std::chrono::steady_clock::now();
+  Preprocessing result;
+  result.graph = build_conflict_graph(data);
+  result.components = connected_components(result.graph);
+  for (std::vector<uint32_t>& component : result.components) {
+    component = order_variables(result.graph, component, order);
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+#endif
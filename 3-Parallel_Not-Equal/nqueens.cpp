@@ -5,100 +5,245 @@
  * Description:
  * This program solves the N-Queens problem using a sequential Depth-First tree-Search
  * (DFS) algorithm. It serves as a basis for task-parallel implementations.
+ *
+ * With `--threads K`, the search is run by K workers that each own a deque of nodes
+ * and steal from the others when their own deque runs dry (work stealing).
+ * With `--frontier D`, the tree is first expanded breadth-first down to depth D, then
+ * the frontier nodes are solved independently by a parallel-for over K threads.
+ * With `--symmetry`, only the canonical half of the tree is explored, using the mirror
+ * symmetry of the board, and the statistics are rescaled.
+ * With `--checkpoint FILE`, the open nodes and the counters of the work-stealing search are
+ * periodically saved, and `--resume FILE` restarts the search from them.
+ * With `--procs P`, the frontier subtrees are distributed to P worker processes by a
+ * coordinator, over a Unix domain socket (see distributed.hpp).
+ * With `--progress S`, the work-stealing search reports its throughput, pool size, steals,
+ * idle times and an estimate of the remaining time every S seconds, on the error output.
+ * With `--pool P`, the workers of the work-stealing search use the given kind of node pool
+ * (see pool.hpp).
+ * With `--budget-nodes N` or `--budget-bytes B`, the tree is expanded breadth-first until N
+ * nodes (or B bytes of nodes) are open, then explored depth-first by the work-stealing
+ * workers, which fall back to breadth-first while some of them are idle (hybrid search).
+ * With `--solutions FILE`, every solution found is written to FILE (`-`: the standard
+ * output) as a line of columns, or as N bytes with `--binary`, by per-thread buffered
+ * writers. With `--first K`, the search stops once K solutions are found (and written).
+ * With `--kernel scalar|fixed|sse|avx2`, the children of a node are evaluated by the given
+ * kernel instead of the fastest one supported by the CPU (`fixed`: specialized for N).
  */
 
 #include <iostream>
-#include <cstring>
-#include <utility>
-#include <vector>
+#include <string>
+#include <cctype>
 #include <chrono>
-#include <stack>
+#include <thread>
+#include <algorithm>
 
-// N-Queens node
-struct Node {
-  int depth; // depth in the tree
-  std::vector<int> board; // board configuration (permutation)
+#include "nqueens.hpp"
+#include "distributed.hpp"
 
-  Node(size_t N): depth(0), board(N) {
-    for (int i = 0; i < N; i++) {
-      board[i] = i;
-    }
+int main(int argc, char** argv) {
+  // helper
+  if (argc < 2) {
+    std::cout << "usage: " << argv[0] << " <number of queens> [--threads K] [--frontier D [--schedule static|dynamic|guided]] [--symmetry] [--checkpoint FILE [--checkpoint-interval S]] [--resume FILE] [--progress S]"
+              << " [--budget-nodes N] [--budget-bytes B[K|M|G]] [--solutions FILE [--binary]] [--first K]"
+              << " [--pool locked|chase-lev|global|sequential] [--procs P [--socket PATH] [--no-spawn]] [--kernel auto|scalar|fixed|sse|avx2]" << std::endl;
+    std::cout << "       " << argv[0] << " --connect PATH" << std::endl;
+    exit(1);
   }
-  Node(const Node&) = default;
-  Node(Node&&) = default;
-  Node() = default;
-};
 
-// check if placing a queen is safe (i.e., check if all the queens already placed share
-// a same diagonal)
-bool isSafe(const std::vector<int>& board, const int row, const int col)
-{
-  for (int i = 0; i < row; ++i) {
-    if (board[i] == col - row + i || board[i] == col + row - i) {
-      return false;
+  // worker process of a distributed search
+  if (std::string(argv[1]) == "--connect") {
+    if (argc != 3) {
+      std::cout << "[ERROR] missing value for --connect" << std::endl;
+      exit(1);
     }
+    return distributed_worker(argv[2]) ? 0 : 1;
   }
 
-  return true;
-}
+  SearchConfig config;
+  DistributedConfig distributed;
+  distributed.num_procs = 0;
+  distributed.socket = "/tmp/nqueens-" + std::to_string(::getpid()) + ".sock";
+
+  // problem size (number of queens)
+  config.N = std::stoll(argv[1]);
+  if (config.N > MAX_N) {
+    std::cout << "[ERROR] at most " << MAX_N << " queens are supported" << std::endl;
+    exit(1);
+  }
 
-// evaluate a given node (i.e., check its board configuration) and branch it if it is valid
-// (i.e., generate its child nodes.)
-void evaluate_and_branch(const Node& parent, std::stack<Node>& pool, size_t& tree_loc, size_t& num_sol)
-{
-  int depth = parent.depth;
-  int N = parent.board.size();
-
-  // if the given node is a leaf, then update counter and do nothing
-  if (depth == N) {
-    num_sol++;
-  }
-  // if the given node is not a leaf, then update counter and evaluate/branch it
-  else {
-    for (int j = depth; j < N; j++) {
-      if (isSafe(parent.board, depth, parent.board[j])) {
-        Node child(parent);
-        std::swap(child.board[depth], child.board[j]);
-        child.depth++;
-        pool.push(std::move(child));
-        tree_loc++;
+  // options (without --threads nor --frontier, the search is sequential)
+  size_t num_threads = 0;
+  bool frontier = false;
+  bool hybrid = false;
+  size_t budget_nodes = 0, budget_bytes = 0;
+  for (int i = 2; i < argc; i++) {
+    std::string option(argv[i]);
+    if (option == "--symmetry") {
+      config.symmetry = true;
+      continue;
+    }
+    if (option == "--no-spawn") {
+      distributed.spawn = false;
+      continue;
+    }
+    if (option == "--binary") {
+      config.binary_solutions = true;
+      continue;
+    }
+    if (i + 1 == argc) {
+      std::cout << "[ERROR] missing value for " << option << std::endl;
+      exit(1);
+    }
+    std::string value(argv[++i]);
+    if (option == "--threads") {
+      num_threads = std::stoll(value);
+      if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    else if (option == "--frontier") {
+      frontier = true;
+      config.cutoff = std::stoll(value);
+    }
+    else if (option == "--checkpoint") {
+      config.checkpoint = value;
+    }
+    else if (option == "--checkpoint-interval") {
+      config.checkpoint_interval = std::stod(value);
+    }
+    else if (option == "--progress") {
+      config.progress_interval = std::stod(value);
+    }
+    else if (option == "--budget-nodes") {
+      hybrid = true;
+      budget_nodes = std::stoll(value);
+    }
+    else if (option == "--budget-bytes") {
+      // optional binary suffix: K, M or G
+      size_t suffix = 0;
+      size_t bytes = std::stoll(value, &suffix);
+      if (suffix < value.size()) {
+        char unit = std::toupper(value[suffix]);
+        if (unit == 'K') bytes <<= 10;
+        else if (unit == 'M') bytes <<= 20;
+        else if (unit == 'G') bytes <<= 30;
+        else {
+          std::cout << "[ERROR] unknown unit in " << value << std::endl;
+          exit(1);
+        }
+      }
+      hybrid = true;
+      budget_bytes = bytes;
+    }
+    else if (option == "--solutions") {
+      config.solutions = value;
+    }
+    else if (option == "--first") {
+      config.max_solutions = std::stoll(value);
+      if (config.max_solutions == 0) {
+        std::cout << "[ERROR] --first needs at least one solution" << std::endl;
+        exit(1);
+      }
+    }
+    else if (option == "--resume") {
+      config.resume = value;
+    }
+    else if (option == "--procs") {
+      distributed.num_procs = std::stoll(value);
+    }
+    else if (option == "--socket") {
+      distributed.socket = value;
+    }
+    else if (option == "--kernel") {
+      if (value == "auto") config.kernel = KernelKind::Auto;
+      else if (value == "scalar") config.kernel = KernelKind::Scalar;
+      else if (value == "fixed") config.kernel = KernelKind::Fixed;
+      else if (value == "sse") config.kernel = KernelKind::Sse;
+      else if (value == "avx2") config.kernel = KernelKind::Avx2;
+      else {
+        std::cout << "[ERROR] unknown kernel " << value << std::endl;
+        exit(1);
+      }
+    }
+    else if (option == "--pool") {
+      if (!parse_pool(value, config.pool)) {
+        std::cout << "[ERROR] unknown pool " << value << std::endl;
+        exit(1);
+      }
+    }
+    else if (option == "--schedule") {
+      if (value == "static") config.schedule = Schedule::Static;
+      else if (value == "dynamic") config.schedule = Schedule::Dynamic;
+      else if (value == "guided") config.schedule = Schedule::Guided;
+      else {
+        std::cout << "[ERROR] unknown schedule " << value << std::endl;
+        exit(1);
       }
     }
+    else {
+      std::cout << "[ERROR] unknown option " << option << std::endl;
+      exit(1);
+    }
   }
-}
-
-int main(int argc, char** argv) {
-  // helper
-  if (argc != 2) {
-    std::cout << "usage: " << argv[0] << " <number of queens> " << std::endl;
+  const bool progress = config.progress_interval > 0.0;
+  const bool solutions = !config.solutions.empty() || config.max_solutions > 0;
+  if (distributed.num_procs > 0 && (num_threads > 0 || !config.checkpoint.empty() || progress || hybrid || solutions)) {
+    std::cout << "[ERROR] --procs cannot be combined with --threads, --checkpoint, --progress, a budget, --solutions nor --first" << std::endl;
     exit(1);
   }
+  if (config.binary_solutions && config.solutions.empty()) {
+    std::cout << "[ERROR] --binary needs --solutions FILE" << std::endl;
+    exit(1);
+  }
+  if (frontier && hybrid) {
+    std::cout << "[ERROR] --frontier cannot be combined with a budget" << std::endl;
+    exit(1);
+  }
+  if (hybrid) {
+    // the budgets not given are unbounded
+    config.budget.nodes = budget_nodes;
+    config.budget.bytes = budget_bytes;
+    config.engine = Engine::Hybrid;
+    if (num_threads == 0) num_threads = 1;
+  }
+  else if (frontier) {
+    if (!config.checkpoint.empty() || progress) {
+      std::cout << "[ERROR] checkpoints and progress reports are only supported by the work-stealing search" << std::endl;
+      exit(1);
+    }
+    config.engine = Engine::Frontier;
+    if (num_threads == 0) num_threads = 1;
+  }
+  else if (num_threads > 0 || !config.checkpoint.empty() || progress) {
+    // checkpoints and progress reports are taken by the work-stealing search, with a single
+    // worker if need be
+    config.engine = Engine::WorkStealing;
+    if (num_threads == 0) num_threads = 1;
+  }
+  config.num_threads = std::max<size_t>(num_threads, 1);
 
-  // problem size (number of queens)
-  size_t N = std::stoll(argv[1]);
-  std::cout << "Solving " << N << "-Queens problem\n" << std::endl;
-
-  // initialization of the root node (the board configuration where no queen is placed)
-  Node root(N);
-
-  // initialization of the pool of nodes (stack -> DFS exploration order)
-  std::stack<Node> pool;
-  pool.push(std::move(root));
+  std::cout << "Solving " << config.N << "-Queens problem";
+  if (num_threads > 0) std::cout << " with " << num_threads << " threads";
+  if (distributed.num_procs > 0) std::cout << " with " << distributed.num_procs << " processes";
+  std::cout << "\n" << std::endl;
 
-  // statistics to check correctness (number of nodes explored and number of solutions found)
-  size_t exploredTree = 0;
-  size_t exploredSol = 0;
+  // selection of the kernel (measuring the fastest one for `Auto`), before the timing
+  try {
+    config.kernel = resolve_kernel(config.kernel, config.N);
+  }
+  catch (const std::exception& e) {
+    std::cout << "[ERROR] " << e.what() << std::endl;
+    exit(1);
+  }
 
-  // beginning of the Depth-First tree-Search
+  // beginning of the tree-Search
   auto start = std::chrono::steady_clock::now();
 
-  while (pool.size() != 0) {
-    // get a node from the pool
-    Node currentNode(std::move(pool.top()));
-    pool.pop();
-
-    // check the board configuration of the node and branch it if it is valid.
-    evaluate_and_branch(currentNode, pool, exploredTree, exploredSol);
+  SearchResult result;
+  try {
+    result = distributed.num_procs > 0 ? distributed_solve(config, distributed) : solve(config);
+  }
+  catch (const std::exception& e) {
+    std::cout << "[ERROR] " << e.what() << std::endl;
+    exit(1);
   }
 
   auto end = std::chrono::steady_clock::now();
@@ -106,8 +251,36 @@ int main(int argc, char** argv) {
 
   // outputs
   std::cout << "Time taken: " << duration.count() << " milliseconds" << std::endl;
-  std::cout << "Total solutions: " << exploredSol << std::endl;
-  std::cout << "Size of the explored tree: " << exploredTree << std::endl;
+  std::cout << "Peak memory: " << peak_memory_kb() << " KB" << std::endl;
+  std::cout << "Kernel: " << kernel_name(result.kernel) << std::endl;
+  if (result.stopped) {
+    std::cout << "Search stopped after " << config.max_solutions << " solutions (partial counts below)" << std::endl;
+  }
+  if (solutions) {
+    std::cout << "Solutions written: " << result.written << std::endl;
+  }
+  std::cout << "Total solutions: " << result.exploredSol << std::endl;
+  std::cout << "Size of the explored tree: " << result.exploredTree << std::endl;
+  if (result.symmetry) {
+    std::cout << "Size of the explored tree (raw, with symmetry breaking): " << result.rawTree << std::endl;
+  }
+
+  if (result.peak_pool_bytes > 0) {
+    std::cout << "Peak pool footprint: " << (result.peak_pool_bytes + 1023) / 1024 << " KB" << std::endl;
+  }
+  if (hybrid) {
+    std::cout << "Breadth-first frontier: " << result.frontierSize << " nodes" << std::endl;
+  }
+
+  if (frontier && distributed.num_procs == 0) {
+    // load imbalance: busiest thread compared to the average one (1 is a perfect balance)
+    const std::vector<double>& busy_ms = result.busy_ms;
+    double max_ms = *std::max_element(busy_ms.begin(), busy_ms.end());
+    double mean_ms = 0.0;
+    for (double ms : busy_ms) mean_ms += ms / busy_ms.size();
+    std::cout << "Frontier size: " << result.frontierSize << " nodes at depth " << std::min(config.cutoff, config.N) << std::endl;
+    std::cout << "Load imbalance (max/mean busy time): " << (mean_ms > 0.0 ? max_ms / mean_ms : 1.0) << std::endl;
+  }
 
   return 0;
-}
\ No newline at end of file
+}
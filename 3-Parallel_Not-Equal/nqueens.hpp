@@ -0,0 +1,568 @@
+#ifndef PARALLEL_NOT_EQUAL_NQUEENS_HPP
+#define PARALLEL_NOT_EQUAL_NQUEENS_HPP
+
+// N-Queens problem for the generic tree-search engines of backtrack.hpp, shared by the
+// solver (nqueens.cpp) and the benchmark harnesses: node encoding, kernels evaluating the
+// children of a node, symmetry breaking and checkpoint/resume.
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
+#include "backtrack.hpp"
+
+// maximum number of queens supported by the compact node encoding (one bit per column)
+constexpr size_t MAX_N = 32;
+
+// N-Queens node
+//
+// The node is trivially copyable and does not allocate: the board is stored inline and
+// the columns/diagonals attacked by the queens already placed are kept as bitmasks, so
+// that checking a square costs a few bitwise operations instead of a scan of the board.
+// The diagonal masks are relative to the next row to fill: they are shifted by one
+// column each time a queen is placed.
+struct Node {
+  uint32_t cols;  // columns occupied by the queens already placed
+  uint32_t diag1; // columns of the next row attacked along a down-right diagonal
+  uint32_t diag2; // columns of the next row attacked along a down-left diagonal
+  uint8_t N;      // number of queens
+  uint8_t depth;  // depth in the tree
+  uint8_t board[MAX_N]; // board configuration (permutation)
+
+  Node(size_t N): cols(0), diag1(0), diag2(0), N(N), depth(0) {
+    for (size_t i = 0; i < MAX_N; i++) {
+      board[i] = i;
+    }
+  }
+  Node() = default;
+
+  // place the queen of row `depth` in the column `board[j]`
+  void place(int j) {
+    uint32_t bit = uint32_t(1) << board[j];
+    std::swap(board[depth], board[j]);
+    cols |= bit;
+    diag1 = (diag1 | bit) << 1;
+    diag2 = (diag2 | bit) >> 1;
+    depth++;
+  }
+};
+
+// size in bytes of an encoded node: its depth followed by its board
+inline size_t encoded_size(size_t N)
+{
+  return N + 1;
+}
+
+// append the compact encoding of `node` to `out` (the bitmasks are not stored)
+inline void encode_node(const Node& node, std::vector<uint8_t>& out)
+{
+  out.push_back(node.depth);
+  out.insert(out.end(), node.board, node.board + node.N);
+}
+
+// decode a node encoded by `encode_node`, recomputing its bitmasks from the queens placed
+inline Node decode_node(const uint8_t* in, size_t N)
+{
+  Node node(N);
+  node.depth = in[0];
+  std::memcpy(node.board, in + 1, N);
+  for (size_t row = 0; row < node.depth; row++) {
+    uint32_t bit = uint32_t(1) << node.board[row];
+    node.cols |= bit;
+    node.diag1 = (node.diag1 | bit) << 1;
+    node.diag2 = (node.diag2 | bit) >> 1;
+  }
+  return node;
+}
+
+// columns of the next row attacked by the queens already placed
+inline uint32_t attacked(const Node& node)
+{
+  return node.cols | node.diag1 | node.diag2;
+}
+
+// check if placing a queen is safe (i.e., check if none of the queens already placed
+// share a same column or diagonal)
+inline bool isSafe(const uint32_t attacked, const int col)
+{
+  return !((attacked >> col) & 1);
+}
+
+// positions j in [depth, N) of the candidate columns of `node`, as a bitmask
+inline uint32_t candidates(const Node& node)
+{
+  return uint32_t(((uint64_t(1) << node.N) - 1) & ~((uint64_t(1) << node.depth) - 1));
+}
+
+// Kernels computing the safe children of a node: bit j of `safe_children(node)` is set if
+// placing the queen of row `depth` in column `board[j]` is safe. They all give the same
+// result; the vectorized ones test all the candidate columns at once.
+
+// scalar kernel: one candidate column at a time
+struct ScalarKernel {
+  static uint32_t safe_children(const Node& node) {
+    const uint32_t mask = attacked(node);
+    uint32_t safe = 0;
+    for (int j = node.depth; j < node.N; j++) {
+      safe |= uint32_t(isSafe(mask, node.board[j])) << j;
+    }
+    return safe;
+  }
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NQUEENS_X86_KERNELS
+
+// The vectorized kernels first expand the attacked columns into a table of 32 bytes
+// (0xFF if column c is attacked), then look up the entry of each board[j] with byte
+// shuffles, and finally collect the sign bits of the 32 lookups.
+
+// SSSE3 kernel: two 16-byte halves of the board, looked up in two 16-byte tables
+struct SseKernel {
+  __attribute__((target("ssse3")))
+  static uint32_t safe_children(const Node& node) {
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i spread_lo = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m128i spread_hi = _mm_setr_epi8(2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m128i mask = _mm_set1_epi32(attacked(node));
+    const __m128i table_lo = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(mask, spread_lo), bits), bits);
+    const __m128i table_hi = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(mask, spread_hi), bits), bits);
+
+    uint32_t unsafe = 0;
+    for (int half = 0; half < 2; half++) {
+      const __m128i col = _mm_loadu_si128(reinterpret_cast<const __m128i*>(node.board + 16 * half));
+      const __m128i in_hi = _mm_cmpgt_epi8(col, _mm_set1_epi8(15));
+      const __m128i lookup = _mm_or_si128(_mm_andnot_si128(in_hi, _mm_shuffle_epi8(table_lo, col)),
+                                          _mm_and_si128(in_hi, _mm_shuffle_epi8(table_hi, col)));
+      unsafe |= uint32_t(_mm_movemask_epi8(lookup)) << (16 * half);
+    }
+    return ~unsafe & candidates(node);
+  }
+};
+
+// AVX2 kernel: the whole board in one register
+struct Avx2Kernel {
+  __attribute__((target("avx2")))
+  static uint32_t safe_children(const Node& node) {
+    const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                          1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i mask = _mm256_set1_epi32(attacked(node));
+    const __m256i table = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_shuffle_epi8(mask, spread), bits), bits);
+
+    // byte shuffles do not cross the 128-bit lanes: look up both halves of the table and
+    // select with bit 4 of the column, moved to the sign bit of each byte
+    const __m256i col = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(node.board));
+    const __m256i from_lo = _mm256_shuffle_epi8(_mm256_permute2x128_si256(table, table, 0x00), col);
+    const __m256i from_hi = _mm256_shuffle_epi8(_mm256_permute2x128_si256(table, table, 0x11), col);
+    const __m256i lookup = _mm256_blendv_epi8(from_lo, from_hi, _mm256_slli_epi16(col, 3));
+
+    return ~uint32_t(_mm256_movemask_epi8(lookup)) & candidates(node);
+  }
+};
+
+#endif
+
+// range of board sizes with a specialized kernel
+constexpr size_t FIXED_MIN_N = 4;
+constexpr size_t FIXED_MAX_N = 20;
+
+// kernel specialized for boards of N queens: the loop over the board has a constant trip
+// count and is fully unrolled. The positions of the queens already placed need no masking,
+// since their columns are in `cols`.
+template <size_t N>
+struct FixedKernel {
+  static_assert(N <= MAX_N, "boards are at most MAX_N wide");
+
+  static uint32_t safe_children(const Node& node) {
+    const uint32_t mask = attacked(node);
+    uint32_t safe = 0;
+    const size_t depth = node.depth;
+#pragma GCC unroll 32
+    for (size_t j = 0; j < N; j++) {
+      if (j >= depth) safe |= uint32_t(isSafe(mask, node.board[j])) << j;
+    }
+    return safe;
+  }
+};
+
+// kernel used by the search
+enum class KernelKind { Auto, Scalar, Sse, Avx2, Fixed };
+
+inline const char* kernel_name(KernelKind kind)
+{
+  switch (kind) {
+    case KernelKind::Scalar: return "scalar";
+    case KernelKind::Sse: return "sse";
+    case KernelKind::Avx2: return "avx2";
+    case KernelKind::Fixed: return "fixed";
+    default: return "auto";
+  }
+}
+
+// call `f` with an instance of the kernel specialized for boards of `n` queens, or of the
+// scalar kernel if there is none
+template <size_t N = FIXED_MIN_N, typename F>
+void with_fixed_kernel(size_t n, F&& f)
+{
+  if constexpr (N > FIXED_MAX_N) {
+    f(ScalarKernel());
+  }
+  else {
+    if (n == N) f(FixedKernel<N>());
+    else with_fixed_kernel<N + 1>(n, f);
+  }
+}
+
+// call `f` with an instance of the kernel type selected by `kind` for boards of N queens;
+// `kind` must be resolved
+template <typename F>
+void with_kernel(KernelKind kind, size_t N, F&& f)
+{
+  switch (kind) {
+#ifdef NQUEENS_X86_KERNELS
+    case KernelKind::Sse: f(SseKernel()); return;
+    case KernelKind::Avx2: f(Avx2Kernel()); return;
+#endif
+    case KernelKind::Fixed: with_fixed_kernel(N, f); return;
+    default: f(ScalarKernel()); return;
+  }
+}
+
+// estimated fraction of the whole tree below `node` (Knuth's estimator): the product, over
+// the ancestors of the node, of the inverse of their number of children. It is recomputed
+// by replaying the placements of the node, so that the nodes do not carry it.
+inline double subtree_weight(const Node& node)
+{
+  Node current(node.N);
+  double weight = 1.0;
+  for (size_t row = 0; row < node.depth; row++) {
+    weight /= std::max(1, __builtin_popcount(ScalarKernel::safe_children(current)));
+    size_t j = row;
+    while (current.board[j] != node.board[row]) j++;
+    current.place(j);
+  }
+  return weight;
+}
+
+// N-Queens as a problem of the generic engines (see backtrack.hpp), with the children of a
+// node evaluated by `Kernel`
+template <typename Kernel = ScalarKernel>
+struct NQueens {
+  using Node = ::Node;
+  size_t N; // number of queens
+  bool mirror = false; // write the mirror image of each solution too (symmetry breaking)
+  bool binary = false; // write the solutions as N bytes instead of text lines
+
+  explicit NQueens(size_t N): N(N) {}
+
+  inline bool is_leaf(const Node& node) const {return node.depth == node.N;}
+  inline size_t depth(const Node& node) const {return node.depth;}
+
+  // children of a node, in the order of the board positions of their queen
+  template <typename Push>
+  inline void branch(const Node& parent, Push&& push) const {
+    uint32_t safe = Kernel::safe_children(parent);
+    while (safe != 0) {
+      int j = __builtin_ctz(safe);
+      safe &= safe - 1;
+      Node child(parent);
+      child.place(j);
+      push(child);
+    }
+  }
+
+  inline size_t record_size() const {return encoded_size(N);}
+  inline void encode(const Node& node, std::vector<uint8_t>& out) const {encode_node(node, out);}
+  inline double weight(const Node& node) const {return subtree_weight(node);}
+
+  // write a solution as the columns of the queens of rows 0 to N-1: a line of numbers
+  // separated by spaces, or N bytes. With `mirror`, its mirror image is written next.
+  void write_solution(const Node& leaf, SolutionStream::Writer& out) const {
+    char record[3 * MAX_N];
+    for (int image = 0; image < (mirror ? 2 : 1); image++) {
+      if (!out.claim()) return;
+      size_t size = 0;
+      for (size_t row = 0; row < N; row++) {
+        uint8_t col = image == 0 ? leaf.board[row] : N - 1 - leaf.board[row];
+        if (binary) {
+          record[size++] = col;
+          continue;
+        }
+        if (col >= 10) record[size++] = '0' + col / 10;
+        record[size++] = '0' + col % 10;
+        record[size++] = row + 1 < N ? ' ' : '\n';
+      }
+      out.append(record, size);
+    }
+  }
+};
+
+// time a bounded DFS with `Kernel` from the nodes of `sample`, in nanoseconds per node
+template <typename Kernel>
+double time_kernel(const std::vector<Node>& sample)
+{
+  const NQueens<Kernel> problem(sample.front().N);
+  NodeStack<Node> pool;
+  for (const Node& node : sample) pool.push(node);
+  size_t tree_loc = 0, num_sol = 0, steps = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (; steps < 200000 && pool.size() != 0; steps++) {
+    Node currentNode(pool.top());
+    pool.pop();
+    evaluate_and_branch(problem, currentNode, pool, tree_loc, num_sol);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return ns / std::max<size_t>(steps, 1);
+}
+
+// the fastest kernel supported by the CPU for boards of N queens, measured once per N on
+// a bounded search from random nodes: with the bitmask encoding, the scalar kernel is
+// already cheap, and whether the vectorized ones win depends on the CPU.
+inline KernelKind calibrate_kernel(size_t N)
+{
+  static std::mutex lock;
+  static KernelKind calibrated[MAX_N + 1] = {};
+  std::lock_guard<std::mutex> guard(lock);
+  if (calibrated[N] != KernelKind::Auto) return calibrated[N];
+
+  std::minstd_rand rng(N);
+  std::vector<Node> sample;
+  for (int i = 0; i < 64; i++) {
+    Node node(N);
+    size_t depth = rng() % (N / 3 + 1);
+    for (size_t row = 0; row < depth; row++) node.place(row + rng() % (N - row));
+    sample.push_back(node);
+  }
+
+  KernelKind best = KernelKind::Scalar;
+  double best_ns = time_kernel<ScalarKernel>(sample);
+  if (N >= FIXED_MIN_N && N <= FIXED_MAX_N) {
+    with_fixed_kernel(N, [&](auto kernel) {
+      double ns = time_kernel<decltype(kernel)>(sample);
+      if (ns < best_ns) { best = KernelKind::Fixed; best_ns = ns; }
+    });
+  }
+#ifdef NQUEENS_X86_KERNELS
+  if (__builtin_cpu_supports("ssse3")) {
+    double ns = time_kernel<SseKernel>(sample);
+    if (ns < best_ns) { best = KernelKind::Sse; best_ns = ns; }
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    double ns = time_kernel<Avx2Kernel>(sample);
+    if (ns < best_ns) { best = KernelKind::Avx2; best_ns = ns; }
+  }
+#endif
+  return calibrated[N] = best;
+}
+
+// the kernel to use for `kind` and boards of N queens: the fastest one supported by the
+// CPU for `Auto`, and the scalar one for `Fixed` if N has no specialized kernel. Throws if
+// the CPU does not support the requested kernel.
+inline KernelKind resolve_kernel(KernelKind kind, size_t N)
+{
+#ifdef NQUEENS_X86_KERNELS
+  const bool avx2 = __builtin_cpu_supports("avx2");
+  const bool ssse3 = __builtin_cpu_supports("ssse3");
+#else
+  const bool avx2 = false;
+  const bool ssse3 = false;
+#endif
+  switch (kind) {
+    case KernelKind::Auto: return calibrate_kernel(N);
+    case KernelKind::Sse: if (!ssse3) throw std::runtime_error("the SSE kernel (SSSE3) is not supported by this CPU"); break;
+    case KernelKind::Avx2: if (!avx2) throw std::runtime_error("the AVX2 kernel is not supported by this CPU"); break;
+    case KernelKind::Fixed: if (N < FIXED_MIN_N || N > FIXED_MAX_N) return KernelKind::Scalar; break;
+    default: break;
+  }
+  return kind;
+}
+
+// root nodes of the search with symmetry breaking. By the mirror symmetry of the board, a
+// solution whose first queen is in the left half has a twin whose first queen is in the
+// right half, so only the left half of the first row is explored. For odd N, the queen in
+// the middle column of the first row is its own mirror: its subtree is explored with the
+// second queen in the left half only. Every explored solution then stands for exactly
+// two solutions. The nodes generated here are counted in `exploredTree`.
+inline std::vector<Node> symmetric_roots(size_t N, size_t& exploredTree)
+{
+  std::vector<Node> roots;
+  Node root(N);
+  const size_t half = N / 2;
+
+  for (size_t j = 0; j < half; j++) {
+    Node child(root);
+    child.place(j);
+    roots.push_back(child);
+    exploredTree++;
+  }
+
+  if (N % 2 == 1) {
+    Node middle(root);
+    middle.place(half);
+    exploredTree++;
+
+    const uint32_t mask = attacked(middle);
+    for (size_t j = 1; j < N; j++) {
+      if (middle.board[j] < half && isSafe(mask, middle.board[j])) {
+        Node child(middle);
+        child.place(j);
+        roots.push_back(child);
+        exploredTree++;
+      }
+    }
+  }
+
+  return roots;
+}
+
+// configuration of a search
+struct SearchConfig {
+  size_t N = 8;                 // number of queens
+  Engine engine = Engine::Sequential;
+  size_t num_threads = 1;       // number of workers (parallel engines)
+  size_t cutoff = 4;            // depth of the frontier (frontier engine)
+  Schedule schedule = Schedule::Dynamic; // loop schedule (frontier engine)
+  bool symmetry = false;        // explore only the canonical half of the tree
+  std::string checkpoint;       // checkpoint file of the work-stealing engine (empty: none)
+  double checkpoint_interval = 60.0; // time between two checkpoints, in seconds
+  std::string resume;           // checkpoint to resume from (empty: start from the root)
+  double progress_interval = 0.0; // time between two progress reports of the work-stealing engine (0: none)
+  KernelKind kernel = KernelKind::Auto; // kernel evaluating the children of a node
+  PoolKind pool = PoolKind::Locked; // pools of the workers (work-stealing and hybrid engines)
+  MemoryBudget budget;          // open nodes of the breadth-first expansions (hybrid engine)
+  std::string solutions;        // file the solutions are streamed to ("-": standard output, empty: none)
+  bool binary_solutions = false; // write the solutions as N bytes instead of text lines
+  size_t max_solutions = 0;     // stop the search after this many solutions (0: no limit)
+};
+
+// flags of the checkpoint header
+constexpr uint32_t CHECKPOINT_SYMMETRY = 1;
+
+// outcome of a search
+struct SearchResult {
+  size_t exploredTree = 0;      // size of the explored tree (rescaled with symmetry breaking)
+  size_t exploredSol = 0;       // number of solutions found (rescaled with symmetry breaking)
+  size_t rawTree = 0;           // number of nodes actually explored
+  bool symmetry = false;        // whether the statistics were rescaled by symmetry breaking
+  size_t frontierSize = 0;      // number of frontier nodes (frontier and hybrid engines)
+  std::vector<double> busy_ms;  // busy time of each thread (frontier engine)
+  size_t peak_pool_bytes = 0;   // peak footprint of the pools of nodes (work-stealing and hybrid engines)
+  size_t written = 0;           // number of solutions written
+  bool stopped = false;         // whether the search stopped after `max_solutions` (partial counters)
+  KernelKind kernel = KernelKind::Auto; // kernel used to evaluate the nodes
+};
+
+// initial root nodes of the search configured by `config`: the board configuration where
+// no queen is placed, or the canonical placements of the first queens with symmetry
+// breaking, or the open nodes of a checkpoint. The counters of `result` are initialized
+// accordingly. When resuming from a checkpoint, symmetry breaking is enabled if and only
+// if it was enabled in the checkpointed search.
+inline std::vector<Node> initial_roots(const SearchConfig& config, SearchResult& result)
+{
+  const size_t N = config.N;
+  // with less than two queens, the first queen is its own mirror and there is nothing to break
+  result.symmetry = config.symmetry && N >= 2;
+
+  std::vector<Node> roots;
+  if (!config.resume.empty()) {
+    CheckpointHeader header;
+    std::vector<uint8_t> records;
+    if (!read_checkpoint(config.resume, header, records) || header.problem_size != N
+        || header.record_size != encoded_size(N)) {
+      throw std::runtime_error("cannot resume " + std::to_string(N) + "-Queens from " + config.resume);
+    }
+    result.symmetry = header.flags & CHECKPOINT_SYMMETRY;
+    for (size_t i = 0; i < header.num_records; i++) {
+      roots.push_back(decode_node(&records[i * header.record_size], N));
+    }
+    result.exploredTree = header.exploredTree;
+    result.exploredSol = header.exploredSol;
+  }
+  else if (result.symmetry) {
+    roots = symmetric_roots(N, result.exploredTree);
+  }
+  else {
+    roots.push_back(Node(N));
+  }
+
+  return roots;
+}
+
+// rescale the counters of a finished search: with symmetry breaking, every explored node
+// and solution has a mirror twin, except the first-row queen in the middle column for odd N
+inline void rescale(SearchResult& result, size_t N)
+{
+  result.rawTree = result.exploredTree;
+  if (result.symmetry) {
+    result.exploredSol = 2 * result.exploredSol;
+    result.exploredTree = 2 * result.exploredTree - (N % 2);
+  }
+}
+
+// solve the N-Queens problem as configured by `config`
+inline SearchResult solve(const SearchConfig& config)
+{
+  SearchResult result;
+  std::vector<Node> roots = initial_roots(config, result);
+
+  EngineConfig engine;
+  engine.engine = config.engine;
+  engine.num_threads = config.num_threads;
+  engine.cutoff = config.cutoff;
+  engine.schedule = config.schedule;
+  engine.pool = config.pool;
+  engine.checkpoint.file = config.checkpoint;
+  engine.checkpoint.interval = config.checkpoint_interval;
+  engine.checkpoint.header.problem_size = config.N;
+  engine.checkpoint.header.flags = result.symmetry ? CHECKPOINT_SYMMETRY : 0;
+  engine.telemetry.interval = config.progress_interval;
+  engine.budget = config.budget;
+
+  // stream of the solutions, to the standard output if only a limit is given
+  SolutionStream stream;
+  if (!config.solutions.empty() || config.max_solutions > 0) {
+    if (!stream.open(config.solutions.empty() ? "-" : config.solutions)) {
+      throw std::runtime_error("cannot write the solutions to " + config.solutions);
+    }
+    stream.set_limit(config.max_solutions);
+    engine.solutions = &stream;
+  }
+
+  EngineStats stats;
+  stats.exploredTree = result.exploredTree;
+  stats.exploredSol = result.exploredSol;
+  result.kernel = resolve_kernel(config.kernel, config.N);
+  with_kernel(result.kernel, config.N, [&](auto kernel) {
+    NQueens<decltype(kernel)> problem(config.N);
+    problem.mirror = result.symmetry;
+    problem.binary = config.binary_solutions;
+    backtrack(problem, roots, engine, stats);
+  });
+  if (stream.error()) throw std::runtime_error("cannot write the solutions to " + config.solutions);
+  result.written = stream.written();
+  result.stopped = stream.stopped();
+  result.exploredTree = stats.exploredTree;
+  result.exploredSol = stats.exploredSol;
+  result.frontierSize = stats.frontierSize;
+  result.busy_ms = stats.busy_ms;
+  result.peak_pool_bytes = stats.peak_pool_bytes;
+
+  rescale(result, config.N);
+  return result;
+}
+
+#endif
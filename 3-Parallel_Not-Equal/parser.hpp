@@ -1,87 +1,613 @@
+#ifndef PARALLEL_NOT_EQUAL_PARSER_HPP
+#define PARALLEL_NOT_EQUAL_PARSER_HPP
+
 #include<utility>
 #include<map>
 #include<string>
 #include<sstream>
 #include<fstream>
 #include<iostream>
+#include<chrono>
+#include<vector>
+#include<cstdint>
+#include<climits>
+#include<cstring>
+#include<cstdio>
+#include<algorithm>
 #include <cassert>
+#include <thread>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// smallest part of a C section parsed by a thread of its own
+constexpr size_t PARSE_CHUNK_BYTES = size_t(1) << 20;
+
+// Binary instance format (little-endian, as written by the machine):
+//   InstanceHeader
+//   u: n int32 values, at u_offset
+//   C: n rows of words_per_row uint64 words, at C_offset (a multiple of 64): bit j % 64 of
+//      word j / 64 of row i is set if (i,j) is in C; the bits j >= n must be clear
+// The checksum is the hash of all the bytes after the header, up to the end of C.
+
+constexpr char INSTANCE_MAGIC[4] = {'P', 'C', 'O', 'B'};
+constexpr uint32_t INSTANCE_VERSION = 1;
+
+struct InstanceHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t n;             // number of variables
+    uint64_t words_per_row; // (n + 63) / 64
+    uint64_t u_offset;      // offsets in the file, in bytes
+    uint64_t C_offset;
+    uint64_t checksum;
+};
+
+// FNV-1a over 64-bit words (then over the remaining bytes): eight times fewer steps than
+// the byte-wise hash, for large bitsets. A hash is continued over more bytes by passing
+// it as `hash`, as long as the bytes hashed so far are a multiple of 8.
+inline uint64_t fnv1a_words(const char* data, size_t size, uint64_t hash = 14695981039346656037ull){
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    for (; i < size; ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// range of the neighbors of a variable in a CSR adjacency list
+struct Neighbors {
+    const uint32_t* first;
+    const uint32_t* last;
+
+    inline const uint32_t* begin() const {return first;}
+    inline const uint32_t* end() const {return last;}
+    inline size_t size() const {return last - first;}
+};
 
+// Changes to an instance, in the order of the delta file they were read from. A delta
+// file is in the text format of the instances, with only the entries that change: lines
+// "i;u_i" in the U section for new upper bounds, and lines "i,j;1" (or "i,j;0") in the C
+// section for the pairs put in C (or taken out of it). Its N section is optional, and must
+// give the size of the instance if present.
+struct InstanceDelta {
+    struct Pair {
+        uint32_t i, j;
+        bool in; // put in C, or taken out of it
+    };
+    std::vector<std::pair<uint32_t, int>> u; // (i, new u_i)
+    std::vector<Pair> C;
+
+    inline size_t size() const {return u.size() + C.size();}
+};
+
+// Instance of the not-equal problem: n variables with upper bounds u, and the set C of
+// pairs (i,j). C is stored as a packed bitset of n rows of `words_per_row` 64-bit words,
+// laid out as in the binary format: bit j % 64 of word j / 64 of row i is set if (i,j) is
+// in C. After `build_adjacency()`, the pairs are also available as CSR adjacency lists, to
+// iterate the neighbors of a variable directly.
 class Data{
     private:
         size_t n = NULL;
-        int* u;
-        int** C;
-    public:
-        inline size_t get_n(){return n;}
-        inline int* get_u(){return u;}
-        inline int** get_C(){return C;}
-        inline int get_u_at(size_t i){return u[i];}
-        inline int get_C_at(size_t i, size_t j){return C[i][j];}
+        std::vector<int> u;
+        size_t words_per_row = 0;
+        std::vector<uint64_t> C;            // packed bitset, row-major
+        std::vector<size_t> out_offsets;    // CSR: j such that (i,j) in C, for each i
+        std::vector<uint32_t> out_targets;
+        std::vector<size_t> in_offsets;     // CSR: i such that (i,j) in C, for each j
+        std::vector<uint32_t> in_targets;
+        size_t bytes_read = 0;     // size of the last file read
+        double read_seconds = 0.0; // time taken to read it
+        size_t read_threads = 1;   // threads parsing the C section of a text file
 
-        bool read_input(std::string filename){
-            std::ifstream f(filename);
-            if (!f.is_open()){
-                std::cerr << "[ERROR] Couldn't open " << filename << "\n";
+        void allocate(size_t size){
+            n = size;
+            words_per_row = (n + 63) / 64;
+            u.assign(n, 0);
+            C.assign(n * words_per_row, 0);
+            out_offsets.clear();
+            out_targets.clear();
+            in_offsets.clear();
+            in_targets.clear();
+        }
+
+        inline void set_C_at(size_t i, size_t j, bool value){
+            uint64_t& word = C[i * words_per_row + j / 64];
+            uint64_t bit = uint64_t(1) << (j % 64);
+            word = value ? word | bit : word & ~bit;
+        }
+
+        // record the entry (i,j) of the C section of a text file, marking it in `seen` (laid out
+        // as C); false if it was already read. C starts empty, so only the pairs in C are set.
+        // With `atomic`, the words are updated atomically, as the chunks parsed in parallel
+        // share them.
+        template <bool atomic>
+        inline bool record_C_at(size_t i, size_t j, bool value, uint64_t* seen){
+            const size_t w = i * words_per_row + j / 64;
+            const uint64_t bit = uint64_t(1) << (j % 64);
+            if (!atomic) {
+                C[w] |= value ? bit : 0;
+                const bool fresh = !(seen[w] & bit);
+                seen[w] |= bit;
+                return fresh;
+            }
+            if (value) __atomic_fetch_or(&C[w], bit, __ATOMIC_RELAXED);
+            return !(__atomic_fetch_or(&seen[w], bit, __ATOMIC_RELAXED) & bit);
+        }
+
+        static inline void skip_blanks(const char*& p, const char* end){
+            while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        }
+
+        // parse a decimal integer, with an optional sign, after optional blanks; false if it
+        // does not fit in a long long
+        static inline bool parse_int(const char*& p, const char* end, long long& value){
+            skip_blanks(p, end);
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+            if (p == end || *p < '0' || *p > '9') return false;
+            long long v = 0;
+            while (p < end && *p >= '0' && *p <= '9') {
+                const int digit = *p++ - '0';
+                if (v > (LLONG_MAX - digit) / 10) return false;
+                v = 10 * v + digit;
+            }
+            value = negative ? -v : v;
+            skip_blanks(p, end);
+            return true;
+        }
+
+        static inline bool expect(const char*& p, const char* end, char c){
+            if (p == end || *p != c) return false;
+            ++p;
+            return true;
+        }
+
+        // load a binary instance from [begin, end), checking its header and checksum
+        bool parse_binary(const char* begin, const char* end, const std::string& filename){
+            const size_t size = end - begin;
+            InstanceHeader header;
+            std::memcpy(&header, begin, sizeof(header));
+            const size_t words = header.words_per_row;
+            // the header is checked before any size is computed from it: n is bounded by the
+            // file size first, so that the sizes of u and C cannot overflow, and the offsets
+            // are compared with what is left of the file by subtraction, which cannot wrap
+            bool ok = header.version == INSTANCE_VERSION && header.n <= size / sizeof(int32_t)
+                && words == (header.n + 63) / 64 && (words == 0 || header.n <= size / sizeof(uint64_t) / words)
+                && header.u_offset >= sizeof(header) && header.u_offset <= header.C_offset
+                && header.n * sizeof(int32_t) <= header.C_offset - header.u_offset
+                && header.C_offset % 64 == 0 && header.C_offset <= size
+                && header.n * words * sizeof(uint64_t) <= size - header.C_offset;
+            const size_t C_end = ok ? header.C_offset + header.n * words * sizeof(uint64_t) : 0;
+            if (!ok || fnv1a_words(begin + sizeof(header), C_end - sizeof(header)) != header.checksum) {
+                std::cerr << "[ERROR] " << filename << ": invalid or corrupted binary instance\n";
                 return false;
             }
 
-            std::string s;
-            std::string current;
-            std::string delimiter1 = ";";
-            std::string delimiter2 = ",";
-            while(std::getline(f,s)){
-                if (s == "N"){
-                    current = "N";
-                    continue;
+            // u and the rows of C are stored as in memory: copy them
+            allocate(header.n);
+            for (size_t i = 0; i < n; ++i) {
+                int32_t value;
+                std::memcpy(&value, begin + header.u_offset + i * sizeof(value), sizeof(value));
+                if (value < 0) {
+                    std::cerr << "[ERROR] " << filename << ": invalid binary instance (negative bound of " << i << ")\n";
+                    return false;
                 }
-                if (s == "U"){
-                    current = "U";
-                    continue;
+                u[i] = value;
+            }
+            if (!C.empty()) std::memcpy(C.data(), begin + header.C_offset, C.size() * sizeof(uint64_t));
+            // the bits j >= n of the last word of each row are padding, and must be clear
+            const uint64_t padding = ~last_word_mask();
+            for (size_t i = 0; i < n && padding != 0; ++i) {
+                if (C[(i + 1) * words_per_row - 1] & padding) {
+                    std::cerr << "[ERROR] " << filename << ": invalid binary instance (pairs beyond n in row " << i << ")\n";
+                    return false;
                 }
-                if (s == "C"){
-                    current = "C";
+            }
+            return true;
+        }
+
+        // bits of the last word of a row of C that stand for variables j < n
+        inline uint64_t last_word_mask() const {
+            return n % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (n % 64)) - 1;
+        }
+
+        // load the instance in [begin, end): binary if it starts with the magic, text otherwise
+        bool parse_any(const char* begin, const char* end, const std::string& filename){
+            if (size_t(end - begin) >= sizeof(InstanceHeader) && std::memcmp(begin, INSTANCE_MAGIC, sizeof(INSTANCE_MAGIC)) == 0) {
+                return parse_binary(begin, end, filename);
+            }
+            return parse(begin, end, filename);
+        }
+
+        // parse the entries "i,j;value" of the C section in [begin, end), which start on a line
+        // boundary; false, as soon as possible, at a line that is not a valid and new entry
+        // (or a section header), or once `stop` is set by another chunk
+        template <bool atomic>
+        bool parse_C_chunk(const char* begin, const char* end, uint64_t* seen, const std::atomic<bool>& stop){
+            const char* p = begin;
+            size_t lines = 0;
+            while (p < end) {
+                if (++lines % 4096 == 0 && stop.load(std::memory_order_relaxed)) return false;
+                const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                if (eol == nullptr) eol = end;
+                const char* last = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+                skip_blanks(p, last);
+                if (p == last || !((*p >= '0' && *p <= '9') || *p == '-' || *p == '+')) {
+                    if (last - p == 1 && (*p == 'N' || *p == 'U' || *p == 'C')) return false;
+                    p = eol < end ? eol + 1 : end;
                     continue;
                 }
+                long long i = 0, j = 0, value = 0;
+                bool ok = parse_int(p, last, i) && expect(p, last, ',') && parse_int(p, last, j)
+                    && expect(p, last, ';') && parse_int(p, last, value)
+                    && i >= 0 && size_t(i) < n && j >= 0 && size_t(j) < n && p == last;
+                if (!ok || !record_C_at<atomic>(i, j, value != 0, seen)) return false;
+                p = eol < end ? eol + 1 : end;
+            }
+            return true;
+        }
+
+        // parse the C section in [begin, end), up to the end of the file, with `read_threads`
+        // threads, each on a chunk of whole lines; false if a chunk stopped on a line the
+        // line-by-line parser has to handle, leaving C and `seen` partly filled
+        bool parse_C_chunks(const char* begin, const char* end, uint64_t* seen){
+            const size_t chunks = std::min(read_threads, size_t(end - begin) / PARSE_CHUNK_BYTES);
+            std::atomic<bool> stop(false);
+            if (chunks < 2) return parse_C_chunk<false>(begin, end, seen, stop);
+            std::vector<const char*> bounds(chunks + 1, end);
+            bounds[0] = begin;
+            for (size_t k = 1; k < chunks; ++k) {
+                const char* p = std::max(bounds[k - 1], begin + k * (end - begin) / chunks);
+                const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                bounds[k] = eol == nullptr ? end : eol + 1;
+            }
+            auto parse_chunk = [&](size_t k) {
+                if (!parse_C_chunk<true>(bounds[k], bounds[k + 1], seen, stop)) stop = true;
+            };
+            std::vector<std::thread> workers;
+            for (size_t k = 1; k < chunks; ++k) workers.emplace_back(parse_chunk, k);
+            parse_chunk(0);
+            for (std::thread& t : workers) t.join();
+            return !stop;
+        }
+
+        // check that each pair (i,j) was given once in the C section, as marked in `seen`
+        bool check_C_entries(const std::vector<uint64_t>& seen, const std::string& filename){
+            size_t given = 0;
+            for (uint64_t word : seen) given += __builtin_popcountll(word);
+            if (given == n * n) return true;
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < n; ++j) {
+                    if (!((seen[i * words_per_row + j / 64] >> (j % 64)) & 1)) {
+                        std::cerr << "[ERROR] " << filename << ": " << n * n - given << " entries of C missing, the first one is "
+                                  << i << "," << j << "\n";
+                        return false;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // parse the instance in [begin, end) in one pass. Section headers are lines holding
+        // only `N`, `U` or `C`; other lines not starting with a number are ignored. Each pair
+        // (i,j) must be given once in the C section.
+        //
+        // The C section is parsed by chunks (in parallel, see `parse_C_chunks`), assuming it
+        // ends the file. If a chunk meets anything else than new valid entries (a section
+        // header, an invalid line or a duplicate entry), C is cleared and the section is parsed
+        // again line by line, which reports the error with its line number.
+        bool parse(const char* begin, const char* end, const std::string& filename){
+            enum { NONE, SECTION_N, SECTION_U, SECTION_C } current = NONE;
+            bool has_n = false;
+            std::vector<uint64_t> seen; // entries of C read, laid out as C
+            size_t line = 0;
+            const char* p = begin;
 
-                if (current == "N"){
-                    std::stringstream ss(s);
-                    ss >> n;
-                    u = new int[n];
-                    C = new int*[n];
-                    for (int i = 0; i < n; ++i) C[i] = new int[n];
+            while (p < end) {
+                ++line;
+                const char* line_begin = p;
+                const char* eol = p;
+                while (eol < end && *eol != '\n') ++eol;
+                const char* next = eol < end ? eol + 1 : end;
+                const char* last = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+
+                skip_blanks(p, last);
+                if (p == last || !((*p >= '0' && *p <= '9') || *p == '-' || *p == '+')) {
+                    // section header, or a line without data
+                    if (last - line_begin == 1) {
+                        if (*line_begin == 'N') current = SECTION_N;
+                        else if (*line_begin == 'U') current = SECTION_U;
+                        else if (*line_begin == 'C') {
+                            current = SECTION_C;
+                            if (has_n) {
+                                if (parse_C_chunks(next, end, seen.data())) break;
+                                std::fill(C.begin(), C.end(), 0);
+                                std::fill(seen.begin(), seen.end(), 0);
+                            }
+                        }
+                    }
+                    p = next;
+                    continue;
                 }
-                if (current == "U"){
-                    size_t delimiter_id = s.find(delimiter1);
-                    std::string s_id = s.substr(0,delimiter_id);
-                    std::string s_value = s.substr(delimiter_id+1,s.size());
 
-                    std::stringstream ss(s_id);
-                    size_t i;
-                    ss >> i;
-                    u[i] = std::stoi(s_value);
+                long long i = 0, j = 0, value = 0;
+                bool ok = true;
+                if (current == SECTION_N) {
+                    // the size may be repeated (as in pco_3.txt), but not changed
+                    ok = parse_int(p, last, value) && value >= 0 && (!has_n || size_t(value) == n);
+                    if (ok && !has_n) {
+                        allocate(value);
+                        seen.assign(C.size(), 0);
+                        has_n = true;
+                    }
+                }
+                else if (current == SECTION_U) {
+                    ok = has_n && parse_int(p, last, i) && expect(p, last, ';') && parse_int(p, last, value)
+                        && i >= 0 && size_t(i) < n && value >= 0 && value <= INT_MAX;
+                    if (ok) u[i] = value;
+                }
+                else if (current == SECTION_C) {
+                    ok = has_n && parse_int(p, last, i) && expect(p, last, ',') && parse_int(p, last, j)
+                        && expect(p, last, ';') && parse_int(p, last, value)
+                        && i >= 0 && size_t(i) < n && j >= 0 && size_t(j) < n;
+                    if (ok && p == last && !record_C_at<false>(i, j, value != 0, seen.data())) {
+                        std::cerr << "[ERROR] " << filename << ":" << line << ": duplicate entry \""
+                                  << std::string(line_begin, last) << "\"\n";
+                        return false;
+                    }
+                }
+                if (!ok || p != last) {
+                    std::cerr << "[ERROR] " << filename << ":" << line << ": invalid line \""
+                              << std::string(line_begin, last) << "\"\n";
+                    return false;
                 }
-                if (current == "C"){
-                    size_t delimiter_id1 = s.find(delimiter1);
-                    std::string s_id = s.substr(0,delimiter_id1);
-                    std::string s_value = s.substr(delimiter_id1+1,s.size());
+                p = next;
+            }
+
+            if (!has_n) {
+                std::cerr << "[ERROR] " << filename << ": missing N section\n";
+                return false;
+            }
+            return check_C_entries(seen, filename);
+        }
 
-                    size_t delimiter_id2 = s_id.find(delimiter2);
-                    std::string si = s_id.substr(0,delimiter_id2);
-                    std::string sj = s_id.substr(delimiter_id2+1,s_id.size());
+    public:
+        inline size_t get_n(){return n;}
+        inline int* get_u(){return u.data();}
+        inline int get_u_at(size_t i){return u[i];}
+        // 1 if (i,j) is in C, 0 otherwise
+        inline int get_C_at(size_t i, size_t j){return (C[i * words_per_row + j / 64] >> (j % 64)) & 1;}
+        // row i of the bitset of C
+        inline const uint64_t* get_C_row(size_t i){return &C[i * words_per_row];}
+        inline size_t get_words_per_row(){return words_per_row;}
 
-                    size_t sti, stj;
-                    std::stringstream ss1(si);
-                    ss1 >> sti;
-                    std::stringstream ss2(sj);
-                    ss2 >> stj;
-                    C[sti][stj] = std::stoi(s_value);
+        // build the CSR adjacency lists of C, in both directions. The padding bits j >= n of
+        // the last word of each row are cleared first, so that they cannot index past the lists.
+        void build_adjacency(){
+            out_offsets.assign(n + 1, 0);
+            in_offsets.assign(n + 1, 0);
+            const uint64_t last_mask = last_word_mask();
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t* row = &C[i * words_per_row];
+                row[words_per_row - 1] &= last_mask;
+                for (size_t w = 0; w < words_per_row; ++w) {
+                    out_offsets[i + 1] += __builtin_popcountll(row[w]);
+                    for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) in_offsets[64 * w + __builtin_ctzll(bits) + 1]++;
                 }
+            }
+            for (size_t i = 0; i < n; ++i) {
+                out_offsets[i + 1] += out_offsets[i];
+                in_offsets[i + 1] += in_offsets[i];
+            }
+
+            out_targets.resize(out_offsets[n]);
+            in_targets.resize(in_offsets[n]);
+            std::vector<size_t> next(in_offsets.begin(), in_offsets.end() - 1);
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t* row = get_C_row(i);
+                size_t k = out_offsets[i];
+                for (size_t w = 0; w < words_per_row; ++w) {
+                    for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+                        uint32_t j = 64 * w + __builtin_ctzll(bits);
+                        out_targets[k++] = j;
+                        in_targets[next[j]++] = i;
+                    }
+                }
+            }
+        }
+
+        inline bool has_adjacency(){return !out_offsets.empty() || n == 0;}
+        // j such that (i,j) is in C, in increasing order (after `build_adjacency`)
+        inline Neighbors get_out_neighbors(size_t i){
+            return {out_targets.data() + out_offsets[i], out_targets.data() + out_offsets[i + 1]};
+        }
+        // i such that (i,j) is in C, in increasing order (after `build_adjacency`)
+        inline Neighbors get_in_neighbors(size_t j){
+            return {in_targets.data() + in_offsets[j], in_targets.data() + in_offsets[j + 1]};
+        }
+        // number of pairs in C (after `build_adjacency`)
+        inline size_t get_num_pairs(){return out_targets.size();}
+
+        // bytes used by the instance in memory
+        size_t memory_bytes(){
+            return u.size() * sizeof(int) + C.size() * sizeof(uint64_t)
+                + (out_offsets.size() + in_offsets.size()) * sizeof(size_t)
+                + (out_targets.size() + in_targets.size()) * sizeof(uint32_t);
+        }
+
+        // size of the last file read, time taken and throughput
+        inline size_t get_bytes_read(){return bytes_read;}
+        inline double get_read_seconds(){return read_seconds;}
+        inline double get_read_mb_per_s(){return read_seconds > 0.0 ? bytes_read / read_seconds / 1e6 : 0.0;}
+
+        // read an instance, in the text or the binary format: the file is mapped in memory and
+        // parsed in place, without any allocation per line (files that cannot be mapped, e.g.
+        // pipes, are read first). The C section of a text file is parsed by `num_threads`
+        // threads (0: all the hardware threads).
+        bool read_input(std::string filename, size_t num_threads = 0){
+            auto start = std::chrono::steady_clock::now();
+            read_threads = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0){
+                std::cerr << "[ERROR] Couldn't open " << filename << "\n";
+                return false;
+            }
+
+            bool ok;
+            struct stat info;
+            void* mapped = MAP_FAILED;
+            if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+                mapped = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            if (mapped != MAP_FAILED) {
+                ::madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+                const char* text = static_cast<const char*>(mapped);
+                ok = parse_any(text, text + info.st_size, filename);
+                bytes_read = info.st_size;
+                ::munmap(mapped, info.st_size);
+            }
+            else {
+                std::string text;
+                char buffer[1 << 16];
+                ssize_t count;
+                while ((count = ::read(fd, buffer, sizeof(buffer))) > 0) text.append(buffer, count);
+                ok = parse_any(text.data(), text.data() + text.size(), filename);
+                bytes_read = text.size();
+            }
+            ::close(fd);
+
+            read_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return ok;
+        }
 
+        // read the delta file `filename` (see `InstanceDelta`) for this instance
+        bool read_delta(std::string filename, InstanceDelta& delta){
+            std::ifstream f(filename, std::ios::binary);
+            if (!f.is_open()) {
+                std::cerr << "[ERROR] Couldn't open " << filename << "\n";
+                return false;
             }
+            const std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+            delta = InstanceDelta();
+            enum { NONE, SECTION_N, SECTION_U, SECTION_C } current = NONE;
+            size_t line = 0;
+            const char* p = text.data();
+            const char* end = p + text.size();
+            while (p < end) {
+                ++line;
+                const char* line_begin = p;
+                const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                if (eol == nullptr) eol = end;
+                const char* next = eol < end ? eol + 1 : end;
+                const char* last = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+
+                skip_blanks(p, last);
+                if (p == last || !((*p >= '0' && *p <= '9') || *p == '-' || *p == '+')) {
+                    if (last - line_begin == 1) {
+                        if (*line_begin == 'N') current = SECTION_N;
+                        else if (*line_begin == 'U') current = SECTION_U;
+                        else if (*line_begin == 'C') current = SECTION_C;
+                    }
+                    p = next;
+                    continue;
+                }
 
+                long long i = 0, j = 0, value = 0;
+                bool ok = current != NONE;
+                if (current == SECTION_N) {
+                    ok = parse_int(p, last, value) && size_t(value) == n;
+                }
+                else if (current == SECTION_U) {
+                    ok = parse_int(p, last, i) && expect(p, last, ';') && parse_int(p, last, value)
+                        && i >= 0 && size_t(i) < n && value >= 0 && value <= INT_MAX;
+                    if (ok) delta.u.emplace_back(i, value);
+                }
+                else if (current == SECTION_C) {
+                    ok = parse_int(p, last, i) && expect(p, last, ',') && parse_int(p, last, j)
+                        && expect(p, last, ';') && parse_int(p, last, value)
+                        && i >= 0 && size_t(i) < n && j >= 0 && size_t(j) < n;
+                    if (ok) delta.C.push_back({uint32_t(i), uint32_t(j), value != 0});
+                }
+                if (!ok || p != last) {
+                    std::cerr << "[ERROR] " << filename << ":" << line << ": invalid line \""
+                              << std::string(line_begin, last) << "\"\n";
+                    return false;
+                }
+                p = next;
+            }
             return true;
         }
 
+        // apply `delta` in place, in time proportional to its size. The CSR adjacency lists,
+        // if built, are dropped: `build_adjacency()` builds them again.
+        void apply_delta(const InstanceDelta& delta){
+            for (const std::pair<uint32_t, int>& bound : delta.u) u[bound.first] = bound.second;
+            for (const InstanceDelta::Pair& pair : delta.C) set_C_at(pair.i, pair.j, pair.in);
+            if (!delta.C.empty()) {
+                out_offsets.clear();
+                out_targets.clear();
+                in_offsets.clear();
+                in_targets.clear();
+            }
+        }
+
+        // write the instance in the binary format
+        bool write_binary(std::string filename){
+            const size_t words = (n + 63) / 64;
+            InstanceHeader header;
+            std::memcpy(header.magic, INSTANCE_MAGIC, sizeof(header.magic));
+            header.version = INSTANCE_VERSION;
+            header.n = n;
+            header.words_per_row = words;
+            header.u_offset = sizeof(header);
+            header.C_offset = (header.u_offset + n * sizeof(int32_t) + 63) / 64 * 64;
+
+            std::vector<char> body(header.C_offset + n * words * sizeof(uint64_t) - sizeof(header), 0);
+            for (size_t i = 0; i < n; ++i) {
+                int32_t value = u[i];
+                std::memcpy(&body[header.u_offset - sizeof(header) + i * sizeof(value)], &value, sizeof(value));
+            }
+            if (!C.empty()) std::memcpy(&body[header.C_offset - sizeof(header)], C.data(), C.size() * sizeof(uint64_t));
+            header.checksum = fnv1a_words(body.data(), body.size());
+
+            FILE* f = std::fopen(filename.c_str(), "wb");
+            if (f == nullptr) {
+                std::cerr << "[ERROR] Couldn't open " << filename << "\n";
+                return false;
+            }
+            bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+            if (!body.empty()) ok = ok && std::fwrite(body.data(), body.size(), 1, f) == 1;
+            ok = (std::fclose(f) == 0) && ok;
+            if (!ok) std::cerr << "[ERROR] Couldn't write " << filename << "\n";
+            return ok;
+        }
+
+        // write the instance in the text format
+        bool write_text(std::string filename){
+            FILE* f = std::fopen(filename.c_str(), "w");
+            if (f == nullptr) {
+                std::cerr << "[ERROR] Couldn't open " << filename << "\n";
+                return false;
+            }
+            std::fprintf(f, "N\n%zu\nU\n", n);
+            for (size_t i = 0; i < n; ++i) std::fprintf(f, "%zu;%d\n", i, u[i]);
+            std::fprintf(f, "C\n");
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j) std::fprintf(f, "%zu,%zu;%d\n", i, j, get_C_at(i, j));
+            bool ok = std::fclose(f) == 0;
+            if (!ok) std::cerr << "[ERROR] Couldn't write " << filename << "\n";
+            return ok;
+        }
+
         void print_n(){
             assert(n != NULL && "[ERROR] Haven't read input file yet");
             
@@ -101,9 +627,11 @@ class Data{
 
             for (size_t i = 0; i < n; ++i)
                 for (size_t j = 0; j < n; ++j)
-                    printf("C[%ld,%ld] = %d, ", i, j, C[i][j]);
+                    printf("C[%ld,%ld] = %d, ", i, j, get_C_at(i, j));
                 printf("\n");
             return;
         }
 
-};
\ No newline at end of file
+};
+
+#endif
@@ -0,0 +1,277 @@
+/*
+ * Description:
+ * This program solves the not-equal problem of a PCO instance (variables x_i in [0, u_i],
+ * with x_i != x_j for each pair (i,j) in C, see parser.hpp) by branch and prune: a
+ * Depth-First tree-Search (DFS) on the values of one variable at a time, where fixing a
+ * variable removes its value from the domains of its neighbors (see pco.hpp).
+ * It counts all the solutions, like nqueens.cpp counts the N-Queens solutions.
+ *
+ * The instance is preprocessed first (see graph.hpp): its conflict graph is split into
+ * connected components, solved one after the other, and the variables of a component are
+ * branched on by degeneracy order, or by the order given by `--order degree|index`.
+ *
+ * With `--threads K`, the search is run by K workers that each own a deque of nodes
+ * and steal from the others when their own deque runs dry (work stealing).
+ * With `--frontier D`, the tree is first expanded breadth-first down to depth D, then
+ * the frontier nodes are solved independently by a parallel-for over K threads.
+ * With `--budget-nodes N`, the tree is expanded breadth-first until N nodes are open, then
+ * explored depth-first by the work-stealing workers (hybrid search).
+ * With `--pool P`, the workers use the given kind of node pool (see pool.hpp).
+ * With `--solutions FILE`, every solution found is written to FILE (`-`: the standard
+ * output) as a line of values. With `--first K`, the search stops once K solutions are
+ * found (and written).
+ *
+ * With `--maximize` or `--minimize`, it looks for a solution of largest (or smallest) sum
+ * of the x_i instead, by branch and bound: each improvement of the best solution is
+ * reported on the error output (and written to the `--solutions` FILE) as soon as it is
+ * found. With `--best-first`, the open nodes of largest bound are expanded first.
+ *
+ * With `--delta FILE`, the changes of the delta file are applied to the instance before it
+ * is solved (see parser.hpp). With `--warm-start SOLUTION` too, the last solution of the
+ * file SOLUTION, found before the changes, is repaired instead: only the variables broken
+ * by the changes (and their neighbors, if needed) are searched again, and the repaired
+ * solution is written to the `--solutions` FILE.
+ */
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <fstream>
+
+#include "pco.hpp"
+
+int main(int argc, char** argv) {
+  // helper
+  if (argc < 2) {
+    std::cout << "usage: " << argv[0] << " <instance file> [--threads K] [--frontier D [--schedule static|dynamic|guided]] [--budget-nodes N]"
+              << " [--order degeneracy|degree|index] [--pool locked|chase-lev|global|sequential] [--solutions FILE] [--first K]"
+              << " [--maximize|--minimize [--best-first]] [--delta FILE [--warm-start SOLUTION]]" << std::endl;
+    exit(1);
+  }
+
+  PcoConfig config;
+  const std::string filename(argv[1]);
+
+  // options (without --threads nor --frontier, the search is sequential)
+  size_t num_threads = 0;
+  bool frontier = false;
+  bool hybrid = false;
+  bool best_first = false;
+  std::string delta_file;
+  std::string warm_start;
+  for (int i = 2; i < argc; i++) {
+    std::string option(argv[i]);
+    // options without value
+    if (option == "--maximize" || option == "--minimize") {
+      config.objective = option == "--maximize" ? Objective::Maximize : Objective::Minimize;
+      continue;
+    }
+    if (option == "--best-first") {
+      best_first = true;
+      continue;
+    }
+    if (i + 1 == argc) {
+      std::cout << "[ERROR] missing value for " << option << std::endl;
+      exit(1);
+    }
+    std::string value(argv[++i]);
+    if (option == "--threads") {
+      num_threads = std::stoll(value);
+      if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    else if (option == "--frontier") {
+      frontier = true;
+      config.cutoff = std::stoll(value);
+    }
+    else if (option == "--budget-nodes") {
+      hybrid = true;
+      config.budget.nodes = std::stoll(value);
+    }
+    else if (option == "--delta") {
+      delta_file = value;
+    }
+    else if (option == "--warm-start") {
+      warm_start = value;
+    }
+    else if (option == "--solutions") {
+      config.solutions = value;
+    }
+    else if (option == "--first") {
+      config.max_solutions = std::stoll(value);
+      if (config.max_solutions == 0) {
+        std::cout << "[ERROR] --first needs at least one solution" << std::endl;
+        exit(1);
+      }
+    }
+    else if (option == "--order") {
+      if (!parse_order(value, config.order)) {
+        std::cout << "[ERROR] unknown order " << value << std::endl;
+        exit(1);
+      }
+    }
+    else if (option == "--pool") {
+      if (!parse_pool(value, config.pool)) {
+        std::cout << "[ERROR] unknown pool " << value << std::endl;
+        exit(1);
+      }
+    }
+    else if (option == "--schedule") {
+      if (value == "static") config.schedule = Schedule::Static;
+      else if (value == "dynamic") config.schedule = Schedule::Dynamic;
+      else if (value == "guided") config.schedule = Schedule::Guided;
+      else {
+        std::cout << "[ERROR] unknown schedule " << value << std::endl;
+        exit(1);
+      }
+    }
+    else {
+      std::cout << "[ERROR] unknown option " << option << std::endl;
+      exit(1);
+    }
+  }
+  const bool optimize = config.objective != Objective::None;
+  const bool solutions = !optimize && (!config.solutions.empty() || config.max_solutions > 0);
+  if (frontier && hybrid) {
+    std::cout << "[ERROR] --frontier cannot be combined with a budget" << std::endl;
+    exit(1);
+  }
+  if (optimize && config.max_solutions > 0) {
+    std::cout << "[ERROR] --first cannot be combined with an objective" << std::endl;
+    exit(1);
+  }
+  if (best_first && (!optimize || frontier || hybrid)) {
+    std::cout << "[ERROR] --best-first needs an objective, and no frontier nor budget" << std::endl;
+    exit(1);
+  }
+  if (!warm_start.empty() && (delta_file.empty() || optimize || config.max_solutions > 0)) {
+    std::cout << "[ERROR] --warm-start needs a --delta, and no objective nor --first" << std::endl;
+    exit(1);
+  }
+  if (best_first) {
+    config.engine = Engine::BestFirst;
+  }
+  else if (hybrid) {
+    config.engine = Engine::Hybrid;
+  }
+  else if (frontier) {
+    config.engine = Engine::Frontier;
+  }
+  else if (num_threads > 0) {
+    config.engine = Engine::WorkStealing;
+  }
+  config.num_threads = std::max<size_t>(num_threads, 1);
+
+  Data data;
+  if (!data.read_input(filename)) exit(1);
+
+  InstanceDelta delta;
+  if (!delta_file.empty()) {
+    auto start = std::chrono::steady_clock::now();
+    if (!data.read_delta(delta_file, delta)) exit(1);
+    data.apply_delta(delta);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Applied " << delta_file << ": " << delta.u.size() << " bounds and " << delta.C.size()
+              << " pairs changed in " << ms << " milliseconds" << std::endl;
+  }
+
+  if (!warm_start.empty()) {
+    std::vector<int32_t> previous;
+    if (!read_solution(warm_start, data.get_n(), previous)) {
+      std::cout << "[ERROR] no solution of " << data.get_n() << " values in " << warm_start << std::endl;
+      exit(1);
+    }
+    RepairResult repair;
+    try {
+      repair = repair_pco(data, delta, previous, config);
+    }
+    catch (const std::exception& e) {
+      std::cout << "[ERROR] " << e.what() << std::endl;
+      exit(1);
+    }
+    std::cout << "Repair time: " << 1000.0 * repair.seconds << " milliseconds" << std::endl;
+    std::cout << "Variables broken by the changes: " << repair.violated << std::endl;
+    std::cout << "Variables searched again: " << repair.repaired << " (" << repair.rounds << " searches)" << std::endl;
+    std::cout << "Size of the explored tree: " << repair.exploredTree << std::endl;
+    if (!repair.feasible) {
+      std::cout << "The changed instance is infeasible" << std::endl;
+      return 0;
+    }
+    const std::string output = config.solutions.empty() ? "-" : config.solutions;
+    std::ofstream file;
+    if (output != "-") file.open(output);
+    std::ostream& out = output == "-" ? std::cout : file;
+    for (size_t i = 0; i < repair.solution.size(); i++) out << repair.solution[i] << (i + 1 < repair.solution.size() ? ' ' : '\n');
+    if (!out) {
+      std::cout << "[ERROR] cannot write the solution to " << output << std::endl;
+      exit(1);
+    }
+    return 0;
+  }
+
+  data.build_adjacency();
+
+  std::cout << (!optimize ? "Solving" : config.objective == Objective::Maximize ? "Maximizing" : "Minimizing")
+            << " the not-equal problem of " << filename << " (" << data.get_n() << " variables, "
+            << data.get_num_pairs() << " pairs) in " << order_name(config.order) << " order";
+  if (num_threads > 0) std::cout << " with " << num_threads << " threads";
+  std::cout << "\n" << std::endl;
+
+  // beginning of the tree-Search
+  auto start = std::chrono::steady_clock::now();
+
+  PcoResult result;
+  try {
+    result = solve_pco(data, config);
+  }
+  catch (const std::exception& e) {
+    std::cout << "[ERROR] " << e.what() << std::endl;
+    exit(1);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+  // outputs
+  std::cout << "Time taken: " << duration.count() << " milliseconds" << std::endl;
+  std::cout << "Peak memory: " << peak_memory_kb() << " KB" << std::endl;
+  std::cout << "Preprocessing: " << 1000.0 * result.preprocess_seconds << " milliseconds, " << result.components
+            << " components (largest: " << result.largest_component << " variables), " << result.self_loops
+            << " pairs (i,i) dropped" << std::endl;
+  std::cout << "Searches: " << result.searches << std::endl;
+  std::cout << "Node size: " << result.node_bytes << " bytes" << std::endl;
+  if (result.stopped) {
+    std::cout << "Search stopped after " << config.max_solutions << " solutions (partial counts below)" << std::endl;
+  }
+  if (solutions) {
+    std::cout << "Solutions written: " << result.written << std::endl;
+  }
+  if (optimize) {
+    if (result.feasible) std::cout << "Objective (sum of the values): " << result.objective << std::endl;
+    else std::cout << "Objective (sum of the values): infeasible" << std::endl;
+    std::cout << "Improving solutions: " << result.improvements << std::endl;
+  }
+  else {
+    std::cout << "Total solutions: " << (result.saturated ? "more than " : "") << result.exploredSol << std::endl;
+  }
+  std::cout << "Size of the explored tree: " << result.exploredTree << std::endl;
+
+  if (result.peak_pool_bytes > 0) {
+    std::cout << "Peak pool footprint: " << (result.peak_pool_bytes + 1023) / 1024 << " KB" << std::endl;
+  }
+  if (hybrid) {
+    std::cout << "Breadth-first frontier: " << result.frontierSize << " nodes" << std::endl;
+  }
+  if (frontier && !result.busy_ms.empty()) {
+    // load imbalance: busiest thread compared to the average one (1 is a perfect balance)
+    const std::vector<double>& busy_ms = result.busy_ms;
+    double max_ms = *std::max_element(busy_ms.begin(), busy_ms.end());
+    double mean_ms = 0.0;
+    for (double ms : busy_ms) mean_ms += ms / busy_ms.size();
+    std::cout << "Frontier size: " << result.frontierSize << " nodes at depth " << std::min(config.cutoff, data.get_n()) << std::endl;
+    std::cout << "Load imbalance (max/mean busy time): " << (mean_ms > 0.0 ? max_ms / mean_ms : 1.0) << std::endl;
+  }
+
+  return 0;
+}
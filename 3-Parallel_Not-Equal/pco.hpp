@@ -0,0 +1,770 @@
+#ifndef PARALLEL_NOT_EQUAL_PCO_HPP
+#define PARALLEL_NOT_EQUAL_PCO_HPP
+
+// Not-equal problem for the generic tree-search engines of backtrack.hpp: find the
+// assignments of variables x_i in [0, u_i] such that x_i != x_j for each pair (i,j) in C,
+// with the instance read by parser.hpp (`Data`). The search branches on the values of
+// one variable at a time and prunes the domains of its neighbors (branch and prune).
+//
+// Each node holds the domains of all the variables as fixed-width bitsets, so that it is
+// trivially copyable (a copy is one memcpy) and can be moved between the pools of the
+// workers. The bitsets are stored by value: `values[v]` is the set of the variables whose
+// domain holds v, one bit per variable. Fixing x_i to v then removes v from the domains
+// of all the neighbors of i at once, with an and-not of `values[v]` and the adjacency row
+// of i over n / 64 words, which the compiler vectorizes. Only the neighbors that actually
+// lose v are visited next, to update the size of their domain: a neighbor left with one
+// value is fixed in turn, and a neighbor left with none (e.g. already fixed to v) makes
+// the node fail. A propagation costs the adjacency row plus the domains it changes,
+// whatever the size of the domains.
+//
+// The instance is preprocessed first (graph.hpp): a search covers the variables of one
+// connected component of the conflict graph, or of all of them, in the branching order
+// of the preprocessing. The variables are numbered by rank in that order in the nodes.
+//
+// Optimization: to maximize (or minimize) the sum of the x_i, the search is a branch and
+// bound against an incumbent shared by the workers. The bound of a node is the sum of the
+// largest values of its domains, computed with one popcount per word of the bitsets (or,
+// to minimize, a sum over a partition of the variables into cliques, whose variables take
+// different values): a node whose bound does not beat the incumbent is pruned, and a
+// node whose variables are all fixed is a solution, offered to the incumbent and kept as
+// a leaf only if it improves it. The leaves counted are then the improving solutions.
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <fstream>
+#include <climits>
+#include <chrono>
+#include <memory>
+#include <sstream>
+
+#include "backtrack.hpp"
+#include "parser.hpp"
+#include "graph.hpp"
+
+// node capacities (maximum number of variables): the nodes of an instance are sized for
+// the smallest capacity that holds it
+constexpr size_t PCO_MIN_VARS = 64;
+constexpr size_t PCO_MAX_VARS = 4096;
+// domain widths (maximum number of values), chosen from the largest upper bound
+constexpr size_t PCO_SMALL_VALUES = 128;
+constexpr size_t PCO_LARGE_VALUES = 1024;
+// largest node: the pools store the nodes inline, by chunks of 1024
+constexpr size_t PCO_MAX_NODE_BYTES = 1 << 17;
+
+// node of the not-equal search over at most V variables with values in [0, P): the
+// variables of rank < depth are fixed (a single value)
+template <size_t V, size_t P>
+struct PcoNode {
+  static constexpr size_t WORDS = V / 64; // words of a set of variables
+  uint64_t values[P][WORDS]; // bit r of values[v] is set if v is in the domain of the variable of rank r
+  uint16_t size[V];          // number of values in the domain of each variable
+  uint32_t depth;            // number of variables branched on
+
+  inline bool has(size_t r, size_t v) const {return (values[v][r / 64] >> (r % 64)) & 1;}
+
+  // smallest value in the domain of the variable of rank r (its value once fixed)
+  inline int32_t first(size_t r) const {
+    size_t v = 0;
+    while (!has(r, v)) v++;
+    return v;
+  }
+};
+
+// best solution of an optimization, shared by the workers. The solutions are compared by
+// score, which is maximized: the objective, or its opposite when minimizing.
+class Incumbent {
+  std::atomic<int64_t> best{INT64_MIN};
+  std::mutex lock;             // serializes the updates of `values`
+  std::vector<int32_t> values; // values of the best solution, by rank
+  std::function<void(int64_t, const std::vector<int32_t>&)> improved;
+
+ public:
+  Incumbent() = default;
+  // call `improved(score, values)` on each improvement, under the lock of the incumbent
+  explicit Incumbent(std::function<void(int64_t, const std::vector<int32_t>&)> improved): improved(std::move(improved)) {}
+
+  inline int64_t score() const {return best.load(std::memory_order_relaxed);}
+  inline bool found() const {return score() != INT64_MIN;}
+  const std::vector<int32_t>& solution() const {return values;}
+
+  // offer a solution of `n` values, by rank: false if it does not beat the incumbent
+  bool offer(int64_t candidate, const int32_t* solution, size_t n) {
+    int64_t current = best.load();
+    do {
+      if (candidate <= current) return false;
+    } while (!best.compare_exchange_weak(current, candidate));
+    std::lock_guard<std::mutex> guard(lock);
+    // a better solution may have been offered in between
+    if (best.load() == candidate) {
+      values.assign(solution, solution + n);
+      if (improved) improved(candidate, values);
+    }
+    return true;
+  }
+};
+
+// not-equal problem over at most V variables of an instance with values in [0, P) (see
+// the top of the file). The variables must form a union of connected components.
+template <size_t V, size_t P>
+struct NotEqual {
+  using Node = PcoNode<V, P>;
+  static constexpr size_t WORDS = Node::WORDS;
+  std::vector<int> u;             // upper bound of each rank
+  size_t n;                       // number of variables
+  std::vector<uint64_t> adjacent; // rows of WORDS words: bit s of row r set if the variables of ranks r and s are adjacent
+  std::vector<uint32_t> by_index; // ranks of the variables by increasing index
+  int max_value = 0;              // largest upper bound
+  Incumbent* incumbent = nullptr; // optimization: best solution so far (nullptr: count the solutions)
+  bool minimize = false;          // optimization: minimize the sum instead of maximizing it
+  std::vector<std::pair<uint32_t, int32_t>> excluded; // (rank, value of a fixed neighbor)
+  std::vector<uint32_t> clique_of;    // minimization: clique of each rank, in a partition of the ranks
+  std::vector<uint32_t> clique_size;  // number of ranks of each clique
+
+  // search over `variables`, in this order. Their neighbors outside of `variables` must
+  // be given values in `fixed` (by variable), which are removed from their domains.
+  NotEqual(Data& data, const ConflictGraph& graph, const std::vector<uint32_t>& variables,
+           const std::vector<int32_t>* fixed = nullptr)
+      : n(variables.size()), adjacent(V * WORDS, 0), by_index(variables.size()) {
+    if (n > V) throw std::invalid_argument("the instance has more variables than the nodes can hold");
+    std::vector<uint32_t> rank(graph.n, uint32_t(-1));
+    for (size_t r = 0; r < n; r++) {
+      rank[variables[r]] = r;
+      u.push_back(data.get_u_at(variables[r]));
+      max_value = std::max(max_value, u.back());
+    }
+    for (size_t r = 0; r < n; r++) {
+      for (uint32_t k : graph.neighbors(variables[r])) {
+        if (rank[k] != uint32_t(-1)) adjacent[r * WORDS + rank[k] / 64] |= uint64_t(1) << (rank[k] % 64);
+        else if (fixed != nullptr) excluded.emplace_back(r, (*fixed)[k]);
+        else throw std::invalid_argument("the variables searched must be a union of components");
+      }
+    }
+    std::iota(by_index.begin(), by_index.end(), 0);
+    std::sort(by_index.begin(), by_index.end(), [&](uint32_t a, uint32_t b) { return variables[a] < variables[b]; });
+
+    // greedy partition of the ranks into cliques, for the lower bound: each rank in turn starts a
+    // clique, joined by the later ranks adjacent to all its members
+    clique_of.assign(n, uint32_t(-1));
+    std::vector<uint32_t> members;
+    for (size_t r = 0; r < n; r++) {
+      if (clique_of[r] != uint32_t(-1)) continue;
+      members.assign(1, r);
+      for (size_t s = r + 1; s < n; s++) {
+        if (clique_of[s] != uint32_t(-1)) continue;
+        bool all = true;
+        for (uint32_t m : members) all = all && ((adjacent[s * WORDS + m / 64] >> (m % 64)) & 1);
+        if (all) members.push_back(s);
+      }
+      for (uint32_t m : members) clique_of[m] = clique_size.size();
+      clique_size.push_back(members.size());
+    }
+  }
+
+  inline bool is_leaf(const Node& node) const {return node.depth == n;}
+  inline size_t depth(const Node& node) const {return node.depth;}
+
+  // remove the value of the fixed variable x from the domains of its neighbors, fixing in
+  // turn the neighbors left with a single value. False if a domain becomes empty.
+  bool propagate(Node& node, uint32_t x) const {
+    uint32_t queue[V];
+    size_t size = 0;
+    queue[size++] = x;
+    while (size > 0) {
+      const uint32_t i = queue[--size];
+      uint64_t* __restrict domain = node.values[node.first(i)];
+      const uint64_t* __restrict row = &adjacent[i * WORDS];
+      uint64_t removed[WORDS];
+      for (size_t w = 0; w < WORDS; w++) {
+        removed[w] = domain[w] & row[w];
+        domain[w] &= ~row[w];
+      }
+      for (size_t w = 0; w < WORDS; w++) {
+        for (uint64_t bits = removed[w]; bits != 0; bits &= bits - 1) {
+          const uint32_t k = 64 * w + __builtin_ctzll(bits);
+          if (--node.size[k] == 0) return false;
+          if (node.size[k] == 1) queue[size++] = k;
+        }
+      }
+    }
+    return true;
+  }
+
+  // root of the search: the domains [0, u_i] without the values of the fixed neighbors,
+  // pruned by the variables fixed from the start. False if the variables have no solution
+  // already.
+  bool root(Node& node) const {
+    std::memset(&node, 0, sizeof(node));
+    for (size_t r = 0; r < n; r++) {
+      if (u[r] < 0) return false;
+      for (int v = 0; v <= u[r]; v++) node.values[v][r / 64] |= uint64_t(1) << (r % 64);
+      node.size[r] = u[r] + 1;
+    }
+    for (const std::pair<uint32_t, int32_t>& value : excluded) {
+      const uint32_t r = value.first;
+      if (value.second < 0 || value.second > u[r] || !node.has(r, value.second)) continue;
+      node.values[value.second][r / 64] &= ~(uint64_t(1) << (r % 64));
+      if (--node.size[r] == 0) return false;
+    }
+    std::vector<uint32_t> fixed_at_start;
+    for (size_t r = 0; r < n; r++) {
+      if (node.size[r] == 1) fixed_at_start.push_back(r);
+    }
+    for (uint32_t r : fixed_at_start) {
+      // a variable fixed by the propagation of another one was propagated: this removes nothing
+      if (!propagate(node, r)) return false;
+    }
+    return true;
+  }
+
+  // values of the fixed variables, by rank
+  void fixed_values(const Node& node, int32_t* value) const {
+    for (size_t v = 0; v <= size_t(max_value); v++) {
+      for (size_t w = 0; w < WORDS; w++) {
+        for (uint64_t bits = node.values[v][w]; bits != 0; bits &= bits - 1) value[64 * w + __builtin_ctzll(bits)] = v;
+      }
+    }
+  }
+
+  // optimization: largest score of the solutions below a node (exact when the variables
+  // are all fixed, which sets `complete`)
+  int64_t bound(const Node& node, bool& complete) const {
+    return minimize ? -lower_bound(node, complete) : upper_bound(node, complete);
+  }
+
+  // maximization: sum of the largest value of each domain, the first one met by scanning
+  // the values down, with one popcount per word
+  int64_t upper_bound(const Node& node, bool& complete) const {
+    uint64_t seen[WORDS] = {};
+    int64_t sum = 0;
+    size_t bits = 0;
+    for (int v = max_value; v >= 0; v--) {
+      for (size_t w = 0; w < WORDS; w++) {
+        const uint64_t domain = node.values[v][w];
+        sum += int64_t(v) * __builtin_popcountll(domain & ~seen[w]);
+        bits += __builtin_popcountll(domain);
+        seen[w] |= domain;
+      }
+    }
+    complete = bits == n;
+    return sum;
+  }
+
+  // minimization: the variables of a clique take different values, so the sum of a
+  // clique of m variables is at least that of the m smallest values of their domains, and
+  // at least the sum of their smallest values. Both are computed at once by scanning the
+  // values up: the first value met for a variable is its smallest one, and a clique takes
+  // each value met until it has m of them. (The sum of the smallest values alone is too
+  // weak to prune: with the clique partition, 65 times fewer nodes are explored on sparse
+  // random instances of 30 variables.)
+  int64_t lower_bound(const Node& node, bool& complete) const {
+    const size_t cliques = clique_size.size();
+    uint64_t seen[WORDS] = {};
+    uint32_t needed[V];   // values the clique still takes
+    int32_t last[V];      // last value taken by the clique
+    int64_t distinct[V];  // sum of the values taken by the clique
+    int64_t smallest[V];  // sum of the smallest values of the variables of the clique
+    for (size_t c = 0; c < cliques; c++) {
+      needed[c] = clique_size[c];
+      last[c] = -1;
+      distinct[c] = 0;
+      smallest[c] = 0;
+    }
+    size_t bits = 0;
+    for (int32_t v = 0; v <= max_value; v++) {
+      for (size_t w = 0; w < WORDS; w++) {
+        const uint64_t domain = node.values[v][w];
+        bits += __builtin_popcountll(domain);
+        for (uint64_t set = domain; set != 0; set &= set - 1) {
+          const uint32_t c = clique_of[64 * w + __builtin_ctzll(set)];
+          if (needed[c] > 0 && last[c] != v) {
+            distinct[c] += v;
+            needed[c]--;
+            last[c] = v;
+          }
+        }
+        for (uint64_t set = domain & ~seen[w]; set != 0; set &= set - 1) smallest[clique_of[64 * w + __builtin_ctzll(set)]] += v;
+        seen[w] |= domain;
+      }
+    }
+    complete = bits == n;
+    int64_t sum = 0;
+    for (size_t c = 0; c < cliques; c++) sum += std::max(distinct[c], smallest[c]);
+    return sum;
+  }
+
+  // optimization: whether the node may lead to a solution better than the incumbent. A
+  // node whose variables are all fixed is offered to the incumbent, and becomes a leaf.
+  bool promising(Node& node) const {
+    bool complete;
+    const int64_t score = bound(node, complete);
+    if (score <= incumbent->score()) return false;
+    if (!complete) return true;
+    int32_t value[V];
+    fixed_values(node, value);
+    node.depth = n;
+    return incumbent->offer(score, value, n);
+  }
+
+  // best-first search: the nodes of largest bound first
+  inline double priority(const Node& node) const {
+    bool complete;
+    return incumbent != nullptr ? double(bound(node, complete)) : 0.0;
+  }
+
+  // children of a node: the values of the variable of rank `depth`, in increasing order,
+  // or in decreasing order when minimizing, so that the depth-first engines, which pop the
+  // last child first, try the best value first
+  template <typename Push>
+  inline void branch(const Node& parent, Push&& push) const {
+    const uint32_t x = parent.depth;
+    // the incumbent may have improved since the node was created
+    if (incumbent != nullptr) {
+      bool complete;
+      if (bound(parent, complete) <= incumbent->score()) return;
+    }
+    if (parent.size[x] == 1) {
+      // fixed by the propagation, hence already propagated
+      Node child(parent);
+      child.depth++;
+      push(child);
+      return;
+    }
+    // values of the domain of x: the child fixing x to one of them clears the others
+    uint16_t domain[P];
+    size_t size = 0;
+    for (size_t v = 0; v < P; v++) {
+      if (parent.has(x, v)) domain[size++] = v;
+    }
+    const uint64_t bit = uint64_t(1) << (x % 64);
+    for (size_t k = 0; k < size; k++) {
+      const size_t c = minimize ? size - 1 - k : k;
+      Node child(parent);
+      child.depth++;
+      for (size_t d = 0; d < size; d++) {
+        if (d != c) child.values[domain[d]][x / 64] &= ~bit;
+      }
+      child.size[x] = 1;
+      if (!propagate(child, x)) continue;
+      if (incumbent == nullptr || promising(child)) push(child);
+    }
+  }
+
+  // write a solution as the values of the variables by increasing index (x_0 to x_{n-1}
+  // for a search over all the variables), separated by spaces
+  void write_solution(const Node& leaf, SolutionStream::Writer& out) const {
+    if (!out.claim()) return;
+    // the values of all the ranks, from one pass over the bitsets
+    int32_t value[V];
+    fixed_values(leaf, value);
+    char record[12 * V];
+    char* end = record;
+    for (size_t i = 0; i < n; i++) {
+      end = std::to_chars(end, record + sizeof(record), value[by_index[i]]).ptr;
+      *end++ = i + 1 < n ? ' ' : '\n';
+    }
+    out.append(record, end - record);
+  }
+};
+
+// empty value standing for the problem type `Problem`
+template <typename Problem>
+struct ProblemTag {
+  using type = Problem;
+};
+
+// call `f` with the tag of the problem whose nodes hold `n` variables and values up to
+// `max_value`, with the smallest capacity and domain width
+template <size_t V = PCO_MIN_VARS, typename F>
+void with_capacity(size_t n, int max_value, F&& f)
+{
+  if constexpr (V > PCO_MAX_VARS) {
+    throw std::invalid_argument("at most " + std::to_string(PCO_MAX_VARS) + " variables are supported");
+  }
+  else {
+    if (n > V) {
+      with_capacity<4 * V>(n, max_value, f);
+    }
+    else if (max_value < int(PCO_SMALL_VALUES)) {
+      f(ProblemTag<NotEqual<V, PCO_SMALL_VALUES>>());
+    }
+    else if constexpr (sizeof(PcoNode<V, PCO_LARGE_VALUES>) <= PCO_MAX_NODE_BYTES) {
+      if (max_value >= int(PCO_LARGE_VALUES)) {
+        throw std::invalid_argument("the upper bounds must be less than " + std::to_string(PCO_LARGE_VALUES));
+      }
+      f(ProblemTag<NotEqual<V, PCO_LARGE_VALUES>>());
+    }
+    else {
+      throw std::invalid_argument("with " + std::to_string(n) + " variables, the upper bounds must be less than "
+                                  + std::to_string(PCO_SMALL_VALUES));
+    }
+  }
+}
+
+// objective of the search
+enum class Objective {
+  None,     // count (or write) the solutions
+  Maximize, // find a solution of largest sum of the x_i
+  Minimize  // find a solution of smallest sum of the x_i
+};
+
+// configuration of a search
+struct PcoConfig {
+  Engine engine = Engine::Sequential;
+  size_t num_threads = 1;       // number of workers (parallel engines)
+  size_t cutoff = 4;            // depth of the frontier (frontier engine)
+  Schedule schedule = Schedule::Dynamic; // loop schedule (frontier engine)
+  PoolKind pool = PoolKind::Locked; // pools of the workers (work-stealing and hybrid engines)
+  MemoryBudget budget;          // open nodes of the breadth-first expansions (hybrid engine)
+  VariableOrder order = VariableOrder::Degeneracy; // branching order of the variables of a component
+  std::string solutions;        // file the solutions are streamed to ("-": standard output, empty: none)
+  size_t max_solutions = 0;     // stop the search after this many solutions (0: no limit)
+  Objective objective = Objective::None;
+  std::ostream* progress = &std::cerr; // optimization: improvements of the best solution (nullptr: none)
+};
+
+// outcome of a search
+struct PcoResult {
+  size_t exploredTree = 0;      // number of nodes generated, over all the searches
+  size_t exploredSol = 0;       // number of solutions found (product over the components)
+  bool saturated = false;       // the number of solutions does not fit in `exploredSol`
+  size_t frontierSize = 0;      // number of frontier nodes (frontier and hybrid engines)
+  std::vector<double> busy_ms;  // busy time of each thread (frontier engine)
+  size_t peak_pool_bytes = 0;   // peak footprint of the pools of nodes (work-stealing and hybrid engines)
+  size_t node_bytes = 0;        // size of the largest node
+  size_t written = 0;           // number of solutions written
+  bool stopped = false;         // whether the search stopped after `max_solutions` (partial counters)
+  size_t components = 0;        // connected components of the conflict graph
+  size_t largest_component = 0; // variables of the largest one
+  size_t searches = 0;          // searches run (single variables are not searched)
+  size_t self_loops = 0;        // pairs (i,i) of C dropped
+  double preprocess_seconds = 0.0;
+  bool feasible = false;        // optimization: whether a solution was found
+  int64_t objective = 0;        // optimization: sum of the x_i of the best solution
+  std::vector<int32_t> best;    // optimization: values of the best solution, by variable
+  size_t improvements = 0;      // optimization: solutions that improved the best one
+};
+
+// search the variables `variables` (a union of components, in branching order) with the
+// engine of `engine`, adding the statistics to `result`; returns the number of solutions
+// (or of improving solutions, in a branch and bound against `incumbent`)
+// `fixed` gives the values of the neighbors of the variables that are not searched.
+inline size_t search_variables(Data& data, const ConflictGraph& graph, const std::vector<uint32_t>& variables,
+                               const EngineConfig& engine, PcoResult& result, Incumbent* incumbent = nullptr,
+                               bool minimize = false, const std::vector<int32_t>* fixed = nullptr)
+{
+  int max_value = 0;
+  for (uint32_t i : variables) max_value = std::max(max_value, data.get_u_at(i));
+  EngineStats stats;
+  with_capacity(variables.size(), max_value, [&](auto tag) {
+    using Problem = typename decltype(tag)::type;
+    using Node = typename Problem::Node;
+    result.node_bytes = std::max(result.node_bytes, sizeof(Node));
+    Problem problem(data, graph, variables, fixed);
+    problem.incumbent = incumbent;
+    problem.minimize = minimize;
+    std::vector<Node> roots(1);
+    if (!problem.root(roots[0])) return;
+    if (incumbent != nullptr && !problem.promising(roots[0])) return;
+    backtrack(static_cast<const Problem&>(problem), roots, engine, stats);
+  });
+  result.exploredTree += stats.exploredTree;
+  result.frontierSize += stats.frontierSize;
+  result.busy_ms.resize(std::max(result.busy_ms.size(), stats.busy_ms.size()), 0.0);
+  for (size_t t = 0; t < stats.busy_ms.size(); t++) result.busy_ms[t] += stats.busy_ms[t];
+  result.peak_pool_bytes = std::max(result.peak_pool_bytes, stats.peak_pool_bytes);
+  result.searches++;
+  return stats.exploredSol;
+}
+
+// optimize the sum of the x_i of the instance preprocessed in `pre` (see `solve_pco`)
+inline void optimize_pco(Data& data, const Preprocessing& pre, const PcoConfig& config, const EngineConfig& engine,
+                         PcoResult& result)
+{
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point start = Clock::now();
+  const bool minimize = config.objective == Objective::Minimize;
+  std::ofstream solutions;
+  if (!config.solutions.empty()) {
+    solutions.open(config.solutions);
+    if (!solutions.is_open()) throw std::runtime_error("cannot write the solutions to " + config.solutions);
+  }
+
+  // best solution of each component, combined into the best solution of the instance; a
+  // single variable takes its best value directly
+  std::vector<int64_t> objectives(pre.components.size(), 0);
+  std::vector<bool> solved(pre.components.size(), true);
+  std::vector<std::unique_ptr<Incumbent>> incumbents(pre.components.size());
+  size_t missing = 0; // components without a solution yet
+  result.best.assign(data.get_n(), 0);
+  // anytime output: the best solution of the instance so far
+  auto report = [&]() {
+    int64_t total = 0;
+    for (int64_t objective : objectives) total += objective;
+    result.objective = total;
+    if (config.progress != nullptr) {
+      *config.progress << "[anytime] " << std::chrono::duration<double, std::milli>(Clock::now() - start).count()
+                       << " ms: sum = " << total << std::endl;
+    }
+    if (solutions.is_open()) {
+      for (size_t i = 0; i < result.best.size(); i++) solutions << result.best[i] << (i + 1 < result.best.size() ? ' ' : '\n');
+      solutions.flush();
+    }
+  };
+  for (size_t c = 0; c < pre.components.size(); c++) {
+    const std::vector<uint32_t>& component = pre.components[c];
+    if (component.size() == 1) {
+      const int u = data.get_u_at(component[0]);
+      if (u < 0) return;
+      result.best[component[0]] = objectives[c] = minimize ? 0 : u;
+      continue;
+    }
+    missing++;
+    solved[c] = false;
+    incumbents[c].reset(new Incumbent([&, c](int64_t score, const std::vector<int32_t>& values) {
+      const std::vector<uint32_t>& variables = pre.components[c];
+      if (!solved[c]) {
+        solved[c] = true;
+        missing--;
+      }
+      objectives[c] = minimize ? -score : score;
+      for (size_t r = 0; r < variables.size(); r++) result.best[variables[r]] = values[r];
+      result.improvements++;
+      if (missing == 0) report();
+    }));
+  }
+
+  // first a solution of each component, by DFS, so that a solution of the instance is known
+  // early; a component without solution makes the instance infeasible
+  EngineConfig first(engine);
+  if (first.engine != Engine::Sequential) first.engine = Engine::WorkStealing;
+  for (size_t c = 0; c < pre.components.size(); c++) {
+    if (incumbents[c] == nullptr) continue;
+    SolutionStream stop; // not opened: stops at the first solution
+    stop.set_limit(1);
+    first.solutions = &stop;
+    search_variables(data, pre.graph, pre.components[c], first, result, incumbents[c].get(), minimize);
+    if (!incumbents[c]->found()) return;
+  }
+  result.feasible = true;
+  if (std::none_of(incumbents.begin(), incumbents.end(), [](const std::unique_ptr<Incumbent>& i) { return i != nullptr; })) {
+    report(); // single variables only: nothing to search
+    return;
+  }
+
+  // then the branch and bound of each component, from its first solution
+  for (size_t c = 0; c < pre.components.size(); c++) {
+    if (incumbents[c] == nullptr) continue;
+    search_variables(data, pre.graph, pre.components[c], engine, result, incumbents[c].get(), minimize);
+  }
+}
+
+// solve the not-equal problem of `data` as configured by `config`
+//
+// Without solutions to write, the components are searched one after the other, each with
+// all the workers, and their numbers of solutions multiplied; a single variable i has
+// u_i + 1 solutions and is not searched, so it adds no node to `exploredTree`, and the
+// search stops at the first component without solution. To write solutions, which span all the components, each component is
+// first checked to have a solution (a search stopped at the first one), then all the
+// variables are searched at once, component after component.
+//
+// To optimize the sum of the x_i, which is the sum of the optimal sums of the components,
+// a first solution of each component is found by DFS, which gives a solution of the
+// instance, then each component is solved by branch and bound from its first solution.
+// The best solution of the instance is reported (and written) each time it improves.
+inline PcoResult solve_pco(Data& data, const PcoConfig& config)
+{
+  PcoResult result;
+  Preprocessing pre = preprocess(data, config.order);
+  result.components = pre.components.size();
+  result.self_loops = pre.graph.self_loops;
+  result.preprocess_seconds = pre.seconds;
+  for (const std::vector<uint32_t>& component : pre.components) {
+    result.largest_component = std::max(result.largest_component, component.size());
+  }
+
+  EngineConfig engine;
+  engine.engine = config.engine;
+  engine.num_threads = config.num_threads;
+  engine.cutoff = config.cutoff;
+  engine.schedule = config.schedule;
+  engine.pool = config.pool;
+  engine.budget = config.budget;
+
+  if (config.objective != Objective::None) {
+    optimize_pco(data, pre, config, engine, result);
+    return result;
+  }
+
+  if (config.solutions.empty() && config.max_solutions == 0) {
+    result.exploredSol = 1;
+    for (const std::vector<uint32_t>& component : pre.components) {
+      size_t count;
+      if (component.size() == 1) {
+        const int u = data.get_u_at(component[0]);
+        count = std::max(u + 1, 0);
+      }
+      else {
+        count = search_variables(data, pre.graph, component, engine, result);
+      }
+      if (__builtin_mul_overflow(result.exploredSol, count, &result.exploredSol)) {
+        result.exploredSol = SIZE_MAX;
+        result.saturated = true;
+      }
+      if (count == 0) {
+        result.exploredSol = 0;
+        result.saturated = false;
+        break;
+      }
+    }
+    return result;
+  }
+
+  // stream of the solutions, to the standard output if only a limit is given; opened
+  // first, so that the file is truncated even if the instance has no solution
+  SolutionStream stream;
+  if (!stream.open(config.solutions.empty() ? "-" : config.solutions)) {
+    throw std::runtime_error("cannot write the solutions to " + config.solutions);
+  }
+  stream.set_limit(config.max_solutions);
+
+  // a component without solution would make the search below explore all the solutions
+  // of the components before it in vain
+  for (const std::vector<uint32_t>& component : pre.components) {
+    if (component.size() == 1 && data.get_u_at(component[0]) >= 0) continue;
+    SolutionStream first; // not opened: only counts the solutions
+    first.set_limit(1);
+    EngineConfig check(engine);
+    check.solutions = &first;
+    if (component.size() > 1) search_variables(data, pre.graph, component, check, result);
+    if (first.written() == 0) return result;
+  }
+
+  engine.solutions = &stream;
+
+  std::vector<uint32_t> variables;
+  for (const std::vector<uint32_t>& component : pre.components) {
+    variables.insert(variables.end(), component.begin(), component.end());
+  }
+  result.exploredSol = search_variables(data, pre.graph, variables, engine, result);
+  if (stream.error()) throw std::runtime_error("cannot write the solutions to " + config.solutions);
+  result.written = stream.written();
+  result.stopped = stream.stopped();
+  return result;
+}
+
+// outcome of the repair of a solution after changes of the instance
+struct RepairResult {
+  bool feasible = false;          // a solution of the changed instance was found
+  std::vector<int32_t> solution;  // its values, by variable
+  size_t violated = 0;            // variables whose value broke a changed constraint
+  size_t repaired = 0;            // variables searched again (in the last region)
+  size_t rounds = 0;              // searches, over growing regions
+  size_t exploredTree = 0;        // nodes generated, over all the searches
+  double seconds = 0.0;           // time taken
+};
+
+// repair `previous`, a solution of the instance before the changes `delta`, into a solution
+// of `data`, to which `delta` is already applied (warm start).
+//
+// Only the changed constraints can be broken: the variables whose value exceeds its new
+// bound, and one variable of each pair put in C with equal values. These variables are
+// searched again, the others keeping their values, which are removed from the domains of
+// their searched neighbors. If they have no solution, their neighbors are added to the
+// search and so on; a region that covers its components without solution proves the
+// instance infeasible. The time taken thus depends on the size of the change and on how
+// far it spreads, rather than on the size of the instance.
+inline RepairResult repair_pco(Data& data, const InstanceDelta& delta, const std::vector<int32_t>& previous,
+                               const PcoConfig& config)
+{
+  auto start = std::chrono::steady_clock::now();
+  const size_t n = data.get_n();
+  if (previous.size() != n) throw std::invalid_argument("the previous solution does not have a value per variable");
+  RepairResult result;
+  result.solution = previous;
+  std::vector<int32_t>& x = result.solution;
+
+  std::vector<bool> in_region(n, false);
+  std::vector<uint32_t> region;
+  auto add = [&](uint32_t i) {
+    if (!in_region[i]) {
+      in_region[i] = true;
+      region.push_back(i);
+    }
+  };
+  for (const std::pair<uint32_t, int>& bound : delta.u) {
+    if (x[bound.first] < 0 || x[bound.first] > data.get_u_at(bound.first)) add(bound.first);
+  }
+  for (const InstanceDelta::Pair& pair : delta.C) {
+    // the pair may have been taken out again later in the delta
+    if (pair.in && pair.i != pair.j && data.get_C_at(pair.i, pair.j) && x[pair.i] == x[pair.j]
+        && !in_region[pair.i] && !in_region[pair.j]) {
+      add(pair.j);
+    }
+  }
+  result.violated = region.size();
+
+  // the first solution found in the region is kept
+  EngineConfig engine;
+  engine.engine = config.engine == Engine::Sequential ? Engine::Sequential : Engine::WorkStealing;
+  engine.num_threads = config.num_threads;
+  engine.pool = config.pool;
+  PcoResult stats;
+  while (!region.empty()) {
+    result.rounds++;
+    const ConflictGraph graph = local_conflict_graph(data, region);
+    const std::vector<uint32_t> variables = order_variables(graph, region, VariableOrder::Degree);
+    Incumbent found;
+    SolutionStream stop; // not opened: stops at the first solution
+    stop.set_limit(1);
+    engine.solutions = &stop;
+    search_variables(data, graph, variables, engine, stats, &found, false, &x);
+    if (found.found()) {
+      for (size_t r = 0; r < variables.size(); r++) x[variables[r]] = found.solution()[r];
+      break;
+    }
+    // no solution: free the neighbors of the region too
+    const size_t size = region.size();
+    for (size_t k = 0; k < size; k++) {
+      for (uint32_t j : graph.neighbors(region[k])) add(j);
+    }
+    if (region.size() == size) {
+      result.repaired = size;
+      result.exploredTree = stats.exploredTree;
+      result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return result; // infeasible
+    }
+  }
+  result.feasible = true;
+  result.repaired = region.size();
+  result.exploredTree = stats.exploredTree;
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+// read the last solution of the file `filename`, as written by `solve_pco` (a line of n
+// values); false if the file cannot be read or has no such line
+inline bool read_solution(const std::string& filename, size_t n, std::vector<int32_t>& solution)
+{
+  std::ifstream f(filename);
+  std::string line;
+  std::string last;
+  while (std::getline(f, line)) {
+    if (line.find_first_not_of(" \t\r") != std::string::npos) last = line;
+  }
+  std::istringstream values(last);
+  solution.clear();
+  long long value;
+  while (values >> value) solution.push_back(value);
+  return f.eof() && solution.size() == n && values.eof();
+}
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef PARALLEL_NOT_EQUAL_POOL_HPP
+#define PARALLEL_NOT_EQUAL_POOL_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+#include "slab.hpp"
+
+// Pools of open nodes for a parallel tree search. Each worker owns one pool; the search
+// loop only uses the following interface, so the pools are interchangeable:
+//
+//   void push(const T&)   owner only: add a node at the back
+//   bool pop(T&)          owner only: take the node pushed last (DFS order)
+//   bool steal(T&)        any thread: take the oldest node (the shallowest one), or fail
+//   size_t size() const   number of nodes, readable by any thread (approximate while busy)
+//   static void share(std::vector<Pool>&)            connect the pools of all the workers
+//   static void snapshot(std::vector<Pool>&, std::vector<T>&)
+//                         append all the nodes, while no thread uses the pools
+//   static size_t footprint(std::vector<Pool>&)      bytes reserved by all the pools, while
+//                         no thread uses them. The pools keep the memory they reserve
+//                         until their destruction, so at the end of a search, it is the
+//                         peak footprint of the search.
+//
+// `steal` may fail spuriously under contention; the caller then tries another victim.
+
+// pool without any synchronization, for a single worker
+template <typename T>
+class SequentialStack {
+    private:
+        SlabDeque<T> nodes;
+
+    public:
+        inline void push(const T& node){nodes.push_back(node);}
+
+        inline bool pop(T& node){
+            if (nodes.empty()) return false;
+            node = nodes.back();
+            nodes.pop_back();
+            return true;
+        }
+
+        inline bool steal(T& node){
+            if (nodes.empty()) return false;
+            node = nodes.front();
+            nodes.pop_front();
+            return true;
+        }
+
+        inline size_t size() const {return nodes.size();}
+
+        static void share(std::vector<SequentialStack>& pools){
+            if (pools.size() > 1) throw std::invalid_argument("the sequential stack cannot be used by several workers");
+        }
+
+        static void snapshot(std::vector<SequentialStack>& pools, std::vector<T>& out){
+            for (SequentialStack& pool : pools) {
+                for (size_t i = 0; i < pool.nodes.size(); i++) out.push_back(pool.nodes[i]);
+            }
+        }
+
+        static size_t footprint(std::vector<SequentialStack>& pools){
+            size_t bytes = 0;
+            for (SequentialStack& pool : pools) bytes += pool.nodes.capacity_bytes();
+            return bytes;
+        }
+};
+
+// deque protected by a mutex, one per worker: the owner and the thieves only contend on
+// the pool of the same worker
+template <typename T>
+class LockedDeque {
+    private:
+        std::mutex lock;
+        SlabDeque<T> nodes;
+        std::atomic<size_t> count{0}; // size of `nodes`, readable without taking the lock
+
+    public:
+        void push(const T& node){
+            std::lock_guard<std::mutex> guard(lock);
+            nodes.push_back(node);
+            count.store(nodes.size(), std::memory_order_relaxed);
+        }
+
+        bool pop(T& node){
+            std::lock_guard<std::mutex> guard(lock);
+            if (nodes.empty()) return false;
+            node = nodes.back();
+            nodes.pop_back();
+            count.store(nodes.size(), std::memory_order_relaxed);
+            return true;
+        }
+
+        bool steal(T& node){
+            std::lock_guard<std::mutex> guard(lock);
+            if (nodes.empty()) return false;
+            node = nodes.front();
+            nodes.pop_front();
+            count.store(nodes.size(), std::memory_order_relaxed);
+            return true;
+        }
+
+        inline size_t size() const {return count.load(std::memory_order_relaxed);}
+
+        static void share(std::vector<LockedDeque>&){}
+
+        static void snapshot(std::vector<LockedDeque>& pools, std::vector<T>& out){
+            for (LockedDeque& pool : pools) {
+                std::lock_guard<std::mutex> guard(pool.lock);
+                for (size_t i = 0; i < pool.nodes.size(); i++) out.push_back(pool.nodes[i]);
+            }
+        }
+
+        static size_t footprint(std::vector<LockedDeque>& pools){
+            size_t bytes = 0;
+            for (LockedDeque& pool : pools) {
+                std::lock_guard<std::mutex> guard(pool.lock);
+                bytes += pool.nodes.capacity_bytes();
+            }
+            return bytes;
+        }
+};
+
+// single deque shared by all the workers behind one mutex: every operation of every
+// worker contends on the same lock. Kept as a baseline for the comparison.
+template <typename T>
+class GlobalQueue {
+    private:
+        struct Shared {
+            std::mutex lock;
+            SlabDeque<T> nodes;
+            std::atomic<size_t> count{0};
+        };
+        std::shared_ptr<Shared> queue = std::make_shared<Shared>();
+
+    public:
+        void push(const T& node){
+            std::lock_guard<std::mutex> guard(queue->lock);
+            queue->nodes.push_back(node);
+            queue->count.store(queue->nodes.size(), std::memory_order_relaxed);
+        }
+
+        bool pop(T& node){
+            std::lock_guard<std::mutex> guard(queue->lock);
+            if (queue->nodes.empty()) return false;
+            node = queue->nodes.back();
+            queue->nodes.pop_back();
+            queue->count.store(queue->nodes.size(), std::memory_order_relaxed);
+            return true;
+        }
+
+        bool steal(T& node){
+            std::lock_guard<std::mutex> guard(queue->lock);
+            if (queue->nodes.empty()) return false;
+            node = queue->nodes.front();
+            queue->nodes.pop_front();
+            queue->count.store(queue->nodes.size(), std::memory_order_relaxed);
+            return true;
+        }
+
+        inline size_t size() const {return queue->count.load(std::memory_order_relaxed);}
+
+        static void share(std::vector<GlobalQueue>& pools){
+            for (GlobalQueue& pool : pools) pool.queue = pools.front().queue;
+        }
+
+        static void snapshot(std::vector<GlobalQueue>& pools, std::vector<T>& out){
+            if (pools.empty()) return;
+            Shared& shared = *pools.front().queue;
+            std::lock_guard<std::mutex> guard(shared.lock);
+            for (size_t i = 0; i < shared.nodes.size(); i++) out.push_back(shared.nodes[i]);
+        }
+
+        static size_t footprint(std::vector<GlobalQueue>& pools){
+            if (pools.empty()) return 0;
+            Shared& shared = *pools.front().queue;
+            std::lock_guard<std::mutex> guard(shared.lock);
+            return shared.nodes.capacity_bytes();
+        }
+};
+
+// slot of a lock-free deque: a trivially copyable element stored as relaxed atomic words,
+// so that a thief may read a slot while the owner overwrites it (the thief then fails
+// its CAS and discards what it read)
+template <typename T>
+struct AtomicSlot {
+    static_assert(std::is_trivially_copyable<T>::value, "slots store elements by bytes");
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    std::atomic<uint64_t> words[WORDS];
+
+    void store(const T& value){
+        uint64_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        for (size_t w = 0; w < WORDS; w++) words[w].store(buffer[w], std::memory_order_relaxed);
+    }
+
+    T load() const {
+        uint64_t buffer[WORDS];
+        for (size_t w = 0; w < WORDS; w++) buffer[w] = words[w].load(std::memory_order_relaxed);
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+};
+
+// Chase-Lev work-stealing deque (Chase & Lev, SPAA 2005, with the memory orders of
+// Le et al., PPoPP 2013): the owner pushes and pops at the bottom without locking, the
+// thieves take from the top with a CAS. Only the last node is contended between the
+// owner and the thieves. When the circular buffer is full, it is replaced by one twice
+// as large; the old buffers are kept until the destruction of the deque, since a thief
+// may still be reading them.
+template <typename T>
+class ChaseLevDeque {
+    private:
+        struct Buffer {
+            int64_t capacity; // power of two
+            std::unique_ptr<AtomicSlot<T>[]> slots;
+
+            explicit Buffer(int64_t capacity): capacity(capacity), slots(new AtomicSlot<T>[capacity]) {}
+            inline AtomicSlot<T>& at(int64_t i){return slots[i & (capacity - 1)];}
+        };
+
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        std::atomic<Buffer*> buffer;
+        std::vector<std::unique_ptr<Buffer>> buffers; // current and retired buffers (owner only)
+
+        Buffer* grow(Buffer* old, int64_t t, int64_t b){
+            buffers.emplace_back(new Buffer(2 * old->capacity));
+            Buffer* larger = buffers.back().get();
+            for (int64_t i = t; i < b; i++) larger->at(i).store(old->at(i).load());
+            buffer.store(larger, std::memory_order_release);
+            return larger;
+        }
+
+    public:
+        explicit ChaseLevDeque(int64_t capacity = 1024){
+            buffers.emplace_back(new Buffer(capacity));
+            buffer.store(buffers.back().get(), std::memory_order_relaxed);
+        }
+        ChaseLevDeque(const ChaseLevDeque&) = delete;
+        ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+        void push(const T& node){
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            Buffer* a = buffer.load(std::memory_order_relaxed);
+            if (b - t > a->capacity - 1) a = grow(a, t, b);
+            a->at(b).store(node);
+            bottom.store(b + 1, std::memory_order_release);
+        }
+
+        bool pop(T& node){
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            Buffer* a = buffer.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_seq_cst);
+            if (t > b) {
+                // empty
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+            node = a->at(b).load();
+            if (t == b) {
+                // last node: race against the thieves for it
+                bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        bool steal(T& node){
+            int64_t t = top.load(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_seq_cst);
+            if (t >= b) return false;
+            Buffer* a = buffer.load(std::memory_order_acquire);
+            T value = a->at(t).load();
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+            node = value;
+            return true;
+        }
+
+        inline size_t size() const {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_relaxed);
+            return b > t ? b - t : 0;
+        }
+
+        static void share(std::vector<ChaseLevDeque>&){}
+
+        static void snapshot(std::vector<ChaseLevDeque>& pools, std::vector<T>& out){
+            for (ChaseLevDeque& pool : pools) {
+                Buffer* a = pool.buffer.load(std::memory_order_acquire);
+                int64_t b = pool.bottom.load(std::memory_order_acquire);
+                for (int64_t i = pool.top.load(std::memory_order_acquire); i < b; i++) out.push_back(a->at(i).load());
+            }
+        }
+
+        // current and retired buffers
+        static size_t footprint(std::vector<ChaseLevDeque>& pools){
+            size_t bytes = 0;
+            for (ChaseLevDeque& pool : pools) {
+                for (const std::unique_ptr<Buffer>& buffer : pool.buffers) bytes += buffer->capacity * sizeof(AtomicSlot<T>);
+            }
+            return bytes;
+        }
+};
+
+// pool implementations
+enum class PoolKind {
+    Locked,   // LockedDeque
+    ChaseLev, // ChaseLevDeque
+    Global,   // GlobalQueue
+    Sequential  // SequentialStack
+};
+
+inline const char* pool_name(PoolKind kind){
+    switch (kind) {
+        case PoolKind::ChaseLev: return "chase-lev";
+        case PoolKind::Global: return "global";
+        case PoolKind::Sequential: return "sequential";
+        default: return "locked";
+    }
+}
+
+inline bool parse_pool(const std::string& name, PoolKind& kind){
+    if (name == "locked") kind = PoolKind::Locked;
+    else if (name == "chase-lev") kind = PoolKind::ChaseLev;
+    else if (name == "global") kind = PoolKind::Global;
+    else if (name == "sequential") kind = PoolKind::Sequential;
+    else return false;
+    return true;
+}
+
+// empty value standing for the pool type `Pool` (pools cannot be copied)
+template <typename Pool>
+struct PoolTag {
+    using type = Pool;
+};
+
+// call `f` with the tag of the pool of elements of type T selected by `kind`
+template <typename T, typename F>
+void with_pool(PoolKind kind, F&& f){
+    switch (kind) {
+        case PoolKind::ChaseLev: f(PoolTag<ChaseLevDeque<T>>()); return;
+        case PoolKind::Global: f(PoolTag<GlobalQueue<T>>()); return;
+        case PoolKind::Sequential: f(PoolTag<SequentialStack<T>>()); return;
+        default: f(PoolTag<LockedDeque<T>>()); return;
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef PARALLEL_NOT_EQUAL_SLAB_HPP
+#define PARALLEL_NOT_EQUAL_SLAB_HPP
+
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+// Double-ended pool of trivially copyable elements stored inline in large chunks.
+//
+// Elements are pushed and popped at the back (DFS order) and can be taken from the front
+// (work stealing). A chunk that becomes empty is not freed but kept in a free list and
+// reused by the next chunk needed, so once the pool has reached its working size, pushing
+// and popping never touch the allocator. Each owner (e.g., each worker thread) has its own
+// slab, so there is no allocator contention between threads.
+template <typename T, size_t ChunkSize = 1024>
+class SlabDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "SlabDeque stores elements by bytes");
+
+    private:
+        std::vector<T*> chunks; // chunks in use, from front to back
+        std::vector<T*> spare;  // empty chunks kept for reuse
+        size_t head = 0;        // position of the front element in chunks[0]
+        size_t tail = 0;        // position one past the back element, relative to chunks[0]
+
+        T* acquire_chunk(){
+            if (spare.empty()) return new T[ChunkSize];
+            T* chunk = spare.back();
+            spare.pop_back();
+            return chunk;
+        }
+
+        void release_back(){
+            spare.push_back(chunks.back());
+            chunks.pop_back();
+        }
+
+        void release_front(){
+            spare.push_back(chunks.front());
+            chunks.erase(chunks.begin());
+            head -= ChunkSize;
+            tail -= ChunkSize;
+        }
+
+    public:
+        // container types, so that the slab can back a std::stack
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+
+        SlabDeque() = default;
+        SlabDeque(const SlabDeque&) = delete;
+        SlabDeque& operator=(const SlabDeque&) = delete;
+        ~SlabDeque(){
+            for (T* chunk : chunks) delete[] chunk;
+            for (T* chunk : spare) delete[] chunk;
+        }
+
+        inline size_t size() const {return tail - head;}
+        inline bool empty() const {return tail == head;}
+        // number of bytes reserved by the chunks (in use or spare)
+        inline size_t capacity_bytes() const {return (chunks.size() + spare.size()) * ChunkSize * sizeof(T);}
+
+        inline T& back(){return chunks[(tail - 1) / ChunkSize][(tail - 1) % ChunkSize];}
+        inline T& front(){return chunks[head / ChunkSize][head % ChunkSize];}
+        // i-th element from the front
+        inline const T& operator[](size_t i) const {return chunks[(head + i) / ChunkSize][(head + i) % ChunkSize];}
+
+        void push_back(const T& value){
+            if (tail == chunks.size() * ChunkSize) chunks.push_back(acquire_chunk());
+            chunks[tail / ChunkSize][tail % ChunkSize] = value;
+            tail++;
+        }
+
+        void pop_back(){
+            tail--;
+            if (tail == head) {
+                // the pool is empty: keep a single chunk and restart from its beginning
+                while (chunks.size() > 1) release_back();
+                head = tail = 0;
+            }
+            else if (tail == (chunks.size() - 1) * ChunkSize) {
+                release_back();
+            }
+        }
+
+        void pop_front(){
+            head++;
+            if (head == tail) {
+                while (chunks.size() > 1) release_back();
+                head = tail = 0;
+            }
+            else if (head == ChunkSize) {
+                release_front();
+            }
+        }
+};
+
+#endif
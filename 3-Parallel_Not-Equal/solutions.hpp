@@ -0,0 +1,146 @@
+#ifndef PARALLEL_NOT_EQUAL_SOLUTIONS_HPP
+#define PARALLEL_NOT_EQUAL_SOLUTIONS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Stream of the solutions of a tree search, written concurrently by the workers.
+//
+// Each worker owns a `SolutionStream::Writer`, which appends the records of its solutions
+// to a private buffer. A full buffer is written as one block: to a regular file, the
+// block reserves its range of the file with an atomic add on the end offset and is then
+// written with `pwrite`, so the workers never wait for each other; to a pipe or a
+// terminal, the blocks are written under a lock. Blocks of different workers interleave,
+// but a record is never split.
+//
+// With a limit of K records, each record first claims a ticket: the first K are written,
+// and the stream asks the search to stop as soon as the K-th is claimed.
+//
+// A stream that is not opened only counts the records (e.g. to stop at the first one).
+
+class SolutionStream {
+    private:
+        int fd = -1;
+        bool owned = false;            // the file was opened by the stream
+        bool seekable = false;         // regular file opened by the stream: blocks are written with pwrite
+        std::mutex lock;               // serializes the blocks written to a pipe or a terminal
+        std::atomic<uint64_t> end{0};  // end of the data reserved in the file
+        std::atomic<uint64_t> tickets{0}; // records claimed (with a limit)
+        std::atomic<uint64_t> records{0}; // records written
+        std::atomic<bool> stop{false};
+        std::atomic<bool> failed{false};
+        uint64_t limit = 0;            // maximum number of records (0: no limit)
+
+        void write_block(const char* data, size_t size){
+            if (fd < 0) return;
+            if (seekable) {
+                uint64_t offset = end.fetch_add(size);
+                while (size > 0) {
+                    ssize_t n = ::pwrite(fd, data, size, offset);
+                    if (n <= 0) { failed.store(true); return; }
+                    data += n;
+                    size -= n;
+                    offset += n;
+                }
+            }
+            else {
+                std::lock_guard<std::mutex> guard(lock);
+                while (size > 0) {
+                    ssize_t n = ::write(fd, data, size);
+                    if (n <= 0) { failed.store(true); return; }
+                    data += n;
+                    size -= n;
+                }
+            }
+        }
+
+    public:
+        SolutionStream() = default;
+        SolutionStream(const SolutionStream&) = delete;
+        SolutionStream& operator=(const SolutionStream&) = delete;
+        ~SolutionStream(){
+            if (owned) ::close(fd);
+        }
+
+        // write to `filename` ("-" for the standard output), truncating it
+        bool open(const std::string& filename){
+            if (filename == "-") {
+                fd = STDOUT_FILENO;
+            }
+            else {
+                fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (fd < 0) {
+                    std::cerr << "[ERROR] Couldn't open " << filename << "\n";
+                    return false;
+                }
+                owned = true;
+            }
+            // the standard output is written with write() even when it is redirected to a
+            // file: pwrite() would not move its offset, and the lines printed afterwards with
+            // std::cout would overwrite the solutions
+            struct stat info;
+            seekable = owned && ::fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+            if (seekable) end.store(::lseek(fd, 0, SEEK_CUR));
+            return true;
+        }
+
+        // write at most `max_records` records (0: no limit), then stop the search
+        void set_limit(uint64_t max_records){limit = max_records;}
+
+        // whether the search is asked to stop
+        inline bool stopped() const {return stop.load(std::memory_order_relaxed);}
+        uint64_t written() const {return records.load();}
+        // whether a block could not be written
+        bool error() const {return failed.load();}
+
+        // buffered writer of a worker, flushed when full and on destruction
+        class Writer {
+            private:
+                SolutionStream& stream;
+                std::vector<char> buffer;
+                uint64_t pending = 0; // records in the buffer
+                size_t capacity;
+
+            public:
+                explicit Writer(SolutionStream& stream, size_t capacity = 1 << 16)
+                    : stream(stream), capacity(capacity) {buffer.reserve(capacity);}
+                Writer(const Writer&) = delete;
+                Writer& operator=(const Writer&) = delete;
+                ~Writer(){flush();}
+
+                inline bool stopped() const {return stream.stopped();}
+
+                // claim a ticket for one more record: false if the limit is reached
+                bool claim(){
+                    if (stream.limit == 0) return true;
+                    uint64_t ticket = stream.tickets.fetch_add(1);
+                    if (ticket + 1 >= stream.limit) stream.stop.store(true);
+                    return ticket < stream.limit;
+                }
+
+                // append a record, after a successful `claim`
+                void append(const char* data, size_t size){
+                    buffer.insert(buffer.end(), data, data + size);
+                    pending++;
+                    if (buffer.size() >= capacity) flush();
+                }
+
+                void flush(){
+                    if (buffer.empty()) return;
+                    stream.write_block(buffer.data(), buffer.size());
+                    stream.records.fetch_add(pending);
+                    buffer.clear();
+                    pending = 0;
+                }
+        };
+};
+
+#endif